@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+// Points-to set kernel benchmark
+//===----------------------------------------------------------------------===//
+//
+// Times the overlap test behind alias queries and the union behind
+// propagation on random sets of site IDs, for several set-size distributions:
+//
+// * `std` - std::set_intersection into a new vector, tested for emptiness,
+//   and std::set_union, as the set pool did before the kernels
+// * `scalar` / `vector` - the sorted array kernels of SiteSetKernels.h with
+//   the vector code forced off and on
+// * `bitvector` - llvm::BitVector over the whole site range (anyCommon, |=),
+//   the spilled representation of SmallSiteSet
+// * `sparse` - llvm::SparseBitVector (intersects, |=), the sets of the
+//   `module` solver
+//
+// Usage: SiteSetBench [pairs per distribution]
+//
+//===----------------------------------------------------------------------===//
+
+#include "SiteSetKernels.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace llvm;
+using namespace dataflow;
+
+namespace {
+
+/**
+ * @brief Sets of SizeA and SizeB sites drawn uniformly from [0, Sites).
+ */
+struct Distribution {
+  const char* Name;
+  unsigned SizeA;
+  unsigned SizeB;
+  unsigned Sites;
+};
+
+const Distribution Distributions[] = {
+    {"tiny 4 x 4, sparse", 4, 4, 1 << 16},
+    {"small 32 x 32, sparse", 32, 32, 1 << 16},
+    {"small 32 x 32, dense", 32, 32, 256},
+    {"medium 256 x 256, sparse", 256, 256, 1 << 16},
+    {"medium 256 x 256, dense", 256, 256, 2048},
+    {"large 4096 x 4096, sparse", 4096, 4096, 1 << 20},
+    {"large 4096 x 4096, dense", 4096, 4096, 1 << 14},
+    {"skewed 4 x 4096, sparse", 4, 4096, 1 << 16},
+};
+
+// Distinct sets per side; pairs cycle through them
+constexpr unsigned NumSets = 64;
+
+std::vector<SiteID> randomSet(std::mt19937& Rng, unsigned Size, unsigned Sites) {
+  std::set<SiteID> Set;
+  std::uniform_int_distribution<SiteID> Site(0, Sites - 1);
+  while (Set.size() < std::min(Size, Sites))
+    Set.insert(Site(Rng));
+  return std::vector<SiteID>(Set.begin(), Set.end());
+}
+
+template <typename BodyT>
+double nanosPerPair(unsigned Pairs, BodyT Body) {
+  auto Start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < Pairs; ++i)
+    Body(i % NumSets, (i / NumSets + i) % NumSets);
+  auto End = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(End - Start).count() / Pairs;
+}
+
+// Keeps the results alive so that the timed loops are not optimized out
+volatile size_t Sink;
+
+void run(const Distribution& D, unsigned Pairs) {
+  std::mt19937 Rng(42);
+  std::vector<std::vector<SiteID>> A, B;
+  std::vector<BitVector> BitsA, BitsB;
+  std::vector<SparseBitVector<>> SparseA, SparseB;
+  for (unsigned i = 0; i < NumSets; ++i) {
+    A.push_back(randomSet(Rng, D.SizeA, D.Sites));
+    B.push_back(randomSet(Rng, D.SizeB, D.Sites));
+    for (auto* Side : {&A, &B}) {
+      BitVector Bits(D.Sites);
+      SparseBitVector<> Sparse;
+      for (SiteID Site : Side->back()) {
+        Bits.set(Site);
+        Sparse.set(Site);
+      }
+      (Side == &A ? BitsA : BitsB).push_back(std::move(Bits));
+      (Side == &A ? SparseA : SparseB).push_back(std::move(Sparse));
+    }
+  }
+
+  size_t Overlapping = 0;
+  for (unsigned i = 0; i < NumSets; ++i)
+    Overlapping += sortedIntersects(A[i], B[(i + 1) % NumSets]);
+
+  // Overlap tests
+  size_t Count = 0;
+  double StdTest = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    std::vector<SiteID> Common;
+    std::set_intersection(
+        A[i].begin(), A[i].end(), B[j].begin(), B[j].end(), std::back_inserter(Common));
+    Count += !Common.empty();
+  });
+  setScalarSiteSetKernels(true);
+  double ScalarTest = nanosPerPair(
+      Pairs, [&](unsigned i, unsigned j) { Count += sortedIntersects(A[i], B[j]); });
+  setScalarSiteSetKernels(false);
+  double VectorTest = nanosPerPair(
+      Pairs, [&](unsigned i, unsigned j) { Count += sortedIntersects(A[i], B[j]); });
+  double BitsTest = nanosPerPair(
+      Pairs, [&](unsigned i, unsigned j) { Count += BitsA[i].anyCommon(BitsB[j]); });
+  double SparseTest = nanosPerPair(
+      Pairs, [&](unsigned i, unsigned j) { Count += SparseA[i].intersects(SparseB[j]); });
+
+  // Unions, into a result reused across pairs as the pool's interning would
+  std::vector<SiteID> Result;
+  double StdUnion = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    Result.clear();
+    std::set_union(
+        A[i].begin(), A[i].end(), B[j].begin(), B[j].end(), std::back_inserter(Result));
+    Count += Result.size();
+  });
+  setScalarSiteSetKernels(true);
+  double ScalarUnion = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    sortedUnion(A[i], B[j], Result);
+    Count += Result.size();
+  });
+  setScalarSiteSetKernels(false);
+  double VectorUnion = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    sortedUnion(A[i], B[j], Result);
+    Count += Result.size();
+  });
+  BitVector Bits;
+  double BitsUnion = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    Bits = BitsA[i];
+    Bits |= BitsB[j];
+    Count += Bits.size();
+  });
+  SparseBitVector<> Sparse;
+  double SparseUnion = nanosPerPair(Pairs, [&](unsigned i, unsigned j) {
+    Sparse = SparseA[i];
+    Sparse |= SparseB[j];
+    Count += Sparse.empty();
+  });
+  Sink = Count;
+
+  outs() << format("%-27s %5.0f%%  ", D.Name, 100.0 * Overlapping / NumSets)
+         << format("%9.1f %9.1f %9.1f %9.1f %9.1f", StdTest, ScalarTest, VectorTest, BitsTest,
+                SparseTest)
+         << format("  %9.1f %9.1f %9.1f %9.1f %9.1f\n", StdUnion, ScalarUnion, VectorUnion,
+                BitsUnion, SparseUnion);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  unsigned Pairs = argc > 1 ? std::atoi(argv[1]) : 20000;
+  outs() << "Vector kernels: " << siteSetKernelISA() << ", " << Pairs
+         << " pairs per distribution, ns per pair\n";
+  outs() << left_justify("", 36) << left_justify("intersects", 51) << "union\n";
+  outs() << left_justify("distribution", 27) << " overlap  ";
+  for (int Operation = 0; Operation < 2; ++Operation) {
+    for (const char* Kind : {"std", "scalar", "vector", "bitvector", "sparse"})
+      outs() << right_justify(Kind, 9) << " ";
+    outs() << " ";
+  }
+  outs() << "\n";
+  for (const Distribution& D : Distributions)
+    run(D, Pairs);
+  return 0;
+}
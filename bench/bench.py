@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Compare the points-to backends on an LLVM IR module.
+
+Runs the PointsTo<mode> pass of the DoubleFree plugin once per backend and
+reports the solver time printed by the pass together with the peak resident
+memory of the opt process. --threads runs each backend once per thread count
+(only the `summary` mode is parallel), and --verify checks every parallel or
+reduced solution against a sequential, unreduced one, outside the timing.
+--edits N retracts and adds back N instructions per function through the
+incremental updates of the `andersen` solver and reports the time per edit;
+with --verify each update is checked against a solve from scratch. For `module`, the nodes merged by the
+offline reduction and the time of the solve after it are listed under each
+run; the mode `module;noreduce` solves without the reduction. The mode
+`summary` times the FunctionSummary pass instead, which summarizes the call
+graph components in parallel; its pointers column counts functions.
+
+Example:
+    ./gen_synthetic.py --functions 100 --pointers 1000 -o synthetic.ll
+    ./bench.py --plugin ../build/DoubleFreePass.so synthetic.ll
+    ./bench.py --modes module --verify synthetic.ll
+    ./bench.py --modes andersen --edits 20 synthetic.ll
+    ./bench.py --modes andersen --stats 5 synthetic.ll
+    ./bench.py --modes "module;noreduce,module" synthetic.ll
+    ./gen_synthetic.py --functions 1000 --pointers 200 --calls 0.02 --acyclic -o dag.ll
+    ./bench.py --modes summary --threads 1,2,4 --verify dag.ll
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import tempfile
+
+
+def run(opt, plugin, mode, threads, verify, edits, stats, module):
+    if mode == "summary":
+        name, params = "FunctionSummary", f"threads={threads}"
+    else:
+        name, params = "PointsTo", f"{mode};threads={threads}"
+    params += ";verify" if verify else ""
+    if edits:
+        params += f";edits={edits}"
+    if stats:
+        params += ";stats"
+    cmd = [opt, f"-load-pass-plugin={plugin}", f"-passes={name}<{params}>",
+           "-disable-output", module]
+    # The statistics go to stderr; a file avoids blocking on a second pipe,
+    # and os.wait4 must reap the process to get its peak memory
+    with tempfile.TemporaryFile("w+") as log:
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                                stderr=log if stats else subprocess.DEVNULL, text=True)
+        out = proc.stdout.read()
+        _, status, usage = os.wait4(proc.pid, 0)
+        log.seek(0)
+        err = log.read()
+    if status != 0:
+        raise RuntimeError(f"{' '.join(cmd)} failed with status {status}")
+
+    total = re.search(r"(?:Points-to total: (\d+) pointers|Summary total: (\d+) functions), "
+                      r"([\d.]+) ms", out)
+    bdd = [int(kb) for kb in re.findall(r"(\d+) KB of BDD nodes", out)]
+    edit = re.search(r"Incremental total: \d+ edits, ([\d.]+) ms", out)
+    reduction = re.search(r"Offline reduction: (\d+) nodes merged in ([\d.]+) ms, "
+                          r"solve ([\d.]+) ms", out)
+    return {
+        "pointers": int(total.group(1) or total.group(2)),
+        "ms": float(total.group(3)),
+        "rss_mb": usage.ru_maxrss / 1024,
+        "bdd_mb": max(bdd) / 1024 if bdd else None,
+        "edit_ms": float(edit.group(1)) if edit else None,
+        "reduction": reduction.groups() if reduction else None,
+        "records": [json.loads(line) for line in err.splitlines()
+                    if line.startswith("{")],
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("modules", nargs="+")
+    parser.add_argument("--plugin", default="build/DoubleFreePass.so")
+    parser.add_argument("--opt", default="opt")
+    parser.add_argument("--modes", default="andersen,bdd")
+    parser.add_argument("--threads", default="1", help="comma-separated thread counts")
+    parser.add_argument("--verify", action="store_true")
+    parser.add_argument("--edits", type=int, default=0, help="edits per function")
+    parser.add_argument("--stats", type=int, default=0, help="slowest functions to show")
+    args = parser.parse_args()
+
+    print(f"{'module':<24} {'mode':<12} {'threads':>7} {'pointers':>9} {'time (s)':>9} "
+          f"{'speedup':>7} {'peak RSS (MB)':>14} {'BDD (MB)':>9} {'edit (ms)':>9}")
+    for module in args.modules:
+        for mode in args.modes.split(","):
+            base = None
+            for threads in args.threads.split(","):
+                r = run(args.opt, args.plugin, mode, int(threads), args.verify, args.edits,
+                        args.stats, module)
+                base = base or r["ms"]
+                bdd = f"{r['bdd_mb']:.1f}" if r["bdd_mb"] is not None else "-"
+                edit = f"{r['edit_ms']:.2f}" if r["edit_ms"] is not None else "-"
+                print(f"{os.path.basename(module):<24} {mode:<12} {threads:>7} "
+                      f"{r['pointers']:>9} {r['ms'] / 1000:>9.2f} {base / r['ms']:>7.2f} "
+                      f"{r['rss_mb']:>14.1f} {bdd:>9} {edit:>9}", flush=True)
+                if r["reduction"]:
+                    merged, reduce_ms, solve_ms = r["reduction"]
+                    print(f"  {merged} nodes merged in {float(reduce_ms):.1f} ms, "
+                          f"solve {float(solve_ms):.1f} ms")
+                slowest = sorted(r["records"], key=lambda rec: -rec["ms"]["solve"])
+                for rec in slowest[:args.stats]:
+                    print(f"  {rec['function']:<22} {rec['ms']['solve']:>8.1f} ms, "
+                          f"{rec['rounds']} rounds, {rec['facts']} facts, "
+                          f"largest set {rec['largest'][0]['size'] if rec['largest'] else 0}")
+
+
+if __name__ == "__main__":
+    main()
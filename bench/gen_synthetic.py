@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Generate a synthetic LLVM IR module for benchmarking the points-to solvers.
+
+Each function is one basic block of random pointer instructions: heap and
+stack allocations, pointer copies (bitcast/getelementptr), loads and stores
+through one and two levels of indirection, and calls to free. Operands are
+drawn from the most recently defined values (--locality), like the short
+def-use distances of real code. All values are named so that printing them is
+cheap.
+
+With --calls, every function takes and returns an i8* and calls functions
+among the next --locality ones of the module, directly or through a global
+function pointer, so that allocations flow between functions (for the
+`module` backend). With --acyclic, a function only calls functions after it
+in the module, picked among all of them, so the call graph is a wide DAG
+(for the function summaries). With --direct, every call is direct and no
+function has its address taken, so that the functions called are only entered
+from their callers (for the call contexts).
+
+With --structs, that fraction of the allocations and of the getelementptrs
+are of a struct of four pointers, and a field address is used both as a slot
+and, cast to i8*, as a value that may be freed (for the field-sensitive
+`andersen` solver).
+"""
+import argparse
+import random
+
+
+def gen_function(out, index, pointers, locality, calls, functions, acyclic, direct, structs, rng):
+    values = ["%arg"] if calls else []    # i8*
+    slots = []     # i8**
+    handles = []   # i8***
+    objects = []   # %struct.S*
+    body = []
+    n = 0
+
+    def pick(pool):
+        return rng.choice(pool[-locality:])
+
+    def fresh(prefix):
+        nonlocal n
+        n += 1
+        return f"%{prefix}{n}"
+
+    while n < pointers:
+        if calls and rng.random() < calls and not (acyclic and index == functions - 1):
+            v = fresh("r")
+            if acyclic:
+                target = rng.randint(index + 1, functions - 1)
+            else:
+                target = (index + rng.randint(1, locality)) % functions
+            if direct or rng.random() < 0.5:
+                callee = f"@f{target}"
+            else:
+                callee = fresh("t")
+                body.append(f"  {callee} = load i8* (i8*)*, i8* (i8*)** @cb{target}")
+            body.append(f"  {v} = call i8* {callee}(i8* {pick(values)})")
+            values.append(v)
+            continue
+
+        r = rng.random()
+        if not values or r < 0.10:
+            v = fresh("m")
+            if structs and rng.random() < structs:
+                o = fresh("o")
+                body.append(f"  {v} = call i8* @malloc(i64 32)")
+                body.append(f"  {o} = bitcast i8* {v} to %struct.S*")
+                objects.append(o)
+            else:
+                body.append(f"  {v} = call i8* @malloc(i64 8)")
+            values.append(v)
+        elif not slots or r < 0.20:
+            s = fresh("s")
+            body.append(f"  {s} = alloca i8*")
+            slots.append(s)
+        elif not handles or r < 0.24:
+            h = fresh("h")
+            body.append(f"  {h} = alloca i8**")
+            handles.append(h)
+        elif r < 0.34:
+            v = fresh("c")
+            body.append(f"  {v} = bitcast i8* {pick(values)} to i8*")
+            values.append(v)
+        elif r < 0.40:
+            if objects and rng.random() < structs:
+                s = fresh("f")
+                body.append(f"  {s} = getelementptr %struct.S, %struct.S* {pick(objects)}, "
+                            f"i32 0, i32 {rng.randint(0, 3)}")
+                slots.append(s)
+                v = fresh("c")
+                body.append(f"  {v} = bitcast i8** {s} to i8*")
+                values.append(v)
+                continue
+            v = fresh("g")
+            body.append(f"  {v} = getelementptr i8, i8* {pick(values)}, i64 1")
+            values.append(v)
+        elif r < 0.58:
+            body.append(f"  store i8* {pick(values)}, i8** {pick(slots)}")
+        elif r < 0.76:
+            v = fresh("l")
+            body.append(f"  {v} = load i8*, i8** {pick(slots)}")
+            values.append(v)
+        elif r < 0.84:
+            body.append(f"  store i8** {pick(slots)}, i8*** {pick(handles)}")
+        elif r < 0.92:
+            s = fresh("d")
+            body.append(f"  {s} = load i8**, i8*** {pick(handles)}")
+            slots.append(s)
+        else:
+            body.append(f"  call void @free(i8* {pick(values)})")
+
+    if calls:
+        if not direct:
+            out.write(f"@cb{index} = global i8* (i8*)* @f{index}\n")
+        out.write(f"define i8* @f{index}(i8* %arg) {{\nentry:\n")
+        out.write("\n".join(body))
+        out.write(f"\n  ret i8* {pick(values)}\n}}\n\n")
+    else:
+        out.write(f"define void @f{index}() {{\nentry:\n")
+        out.write("\n".join(body))
+        out.write("\n  ret void\n}\n\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--functions", type=int, default=1)
+    parser.add_argument("--pointers", type=int, default=1000, help="pointers per function")
+    parser.add_argument("--locality", type=int, default=64,
+                        help="operands are picked among this many most recent values")
+    parser.add_argument("--calls", type=float, default=0,
+                        help="fraction of instructions that are calls to other functions")
+    parser.add_argument("--acyclic", action="store_true",
+                        help="only call functions later in the module")
+    parser.add_argument("--direct", action="store_true",
+                        help="only call functions directly")
+    parser.add_argument("--structs", type=float, default=0,
+                        help="fraction of allocations and getelementptrs that are of structs")
+    parser.add_argument("--seed", type=int, default=5470)
+    parser.add_argument("-o", "--output", default="synthetic.ll")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with open(args.output, "w") as out:
+        if args.structs:
+            out.write("%struct.S = type { i8*, i8*, i8*, i8* }\n\n")
+        out.write("declare i8* @malloc(i64)\ndeclare void @free(i8*)\n\n")
+        for i in range(args.functions):
+            gen_function(out, i, args.pointers, args.locality, args.calls,
+                         args.functions, args.acyclic, args.direct, args.structs, rng)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,114 @@
+#ifndef ANALYSIS_CACHE_H
+#define ANALYSIS_CACHE_H
+
+#include "FunctionSummary.h"
+#include "PointsToBackend.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Persistent Analysis Cache
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Results kept on disk across runs, addressed by the MD5 of a key
+ * built from everything the result depends on.
+ *
+ * Each entry is one file of the cache directory, named by the hex digest of
+ * its key. It is a sequence of little-endian 32-bit words: a magic number,
+ * the format version, the microseconds the analysis took when the entry was
+ * written, the number of payload words and the payload. An entry holds no
+ * pointers or offsets, so it is used as is from the mapped file. Entries are
+ * written to a temporary file and renamed into place, so runs sharing a
+ * directory never read a partial entry. The cache is only an accelerator: an
+ * entry that cannot be read or written is a miss.
+ *
+ * The counters are atomic, so the components summarized concurrently can
+ * share one cache.
+ */
+class AnalysisCache {
+ public:
+  // Bump whenever a change to the analyses, the summaries or the hash changes
+  // a result, so that older entries no longer match
+  static constexpr uint32_t AnalysisVersion = 3;
+
+  AnalysisCache(StringRef Dir);
+
+  /**
+   * @brief Read the payload of the entry for Key, counting a hit and the time
+   * it saves, or a miss.
+   *
+   * @return bool Whether the entry exists and is well formed
+   */
+  bool lookup(const MD5::MD5Result& Key, std::vector<uint32_t>& Payload);
+
+  /**
+   * @brief Write the entry for Key, computed in Ms milliseconds.
+   */
+  void store(const MD5::MD5Result& Key, ArrayRef<uint32_t> Payload, double Ms);
+
+  /**
+   * @brief Print the hits, the misses, the hit rate and the time saved, e.g.
+   * `Summary cache: 90 hits, 10 misses (90.0%), 52.1 ms saved`.
+   */
+  void print(raw_ostream& O, StringRef What) const;
+
+ private:
+  std::string Dir;
+  std::atomic<unsigned> Hits{0};
+  std::atomic<unsigned> Misses{0};
+  // Time the hits took to analyze when stored, less the time to read them.
+  // Printed as 0 when reading took longer.
+  std::atomic<int64_t> SavedMicros{0};
+
+  std::string path(const MD5::MD5Result& Key) const;
+};
+
+/**
+ * @brief Add the structure of F to Hash: its type, and the opcode, type and
+ * operands of every instruction in order. Arguments, blocks and instructions
+ * are numbered by position and other operands are printed, so renaming
+ * values or editing another function leaves the hash unchanged. Debug info
+ * operands are left out, so moving code between lines does too.
+ */
+void hashFunction(const Function& F, MD5& Hash);
+
+/**
+ * @brief Key of the warnings of Analysis on F: the analysis version, the
+ * solver options that change answers, the datalayout and target triple of
+ * the module, the structure of F and the summaries of its direct callees.
+ */
+MD5::MD5Result resultKey(const Function& F,
+    StringRef Analysis,
+    const PointsToOptions& Options,
+    const FunctionSummaries& Summaries);
+
+/**
+ * @brief Positions of Insts among the instructions of F, the payload of a
+ * result entry.
+ */
+std::vector<uint32_t> instructionPositions(Function& F, const SetVector<Instruction*>& Insts);
+
+/**
+ * @brief Add to Insts the instructions of F at Positions.
+ *
+ * @return bool False if some position is past the end of F
+ */
+bool instructionsAt(Function& F, ArrayRef<uint32_t> Positions, SetVector<Instruction*>& Insts);
+
+}  // namespace dataflow
+
+#endif  // ANALYSIS_CACHE_H
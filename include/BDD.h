@@ -0,0 +1,128 @@
+#ifndef BDD_H
+#define BDD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Binary Decision Diagrams
+//===----------------------------------------------------------------------===//
+
+// A BDD is referred to by the index of its root node in its manager.
+using BDD = unsigned;
+
+/**
+ * @brief A small reduced ordered BDD package.
+ *
+ * Nodes are hash-consed in a unique table, so two BDDs represent the same
+ * boolean function if and only if they have the same root. Variables are
+ * ordered by index (variable 0 is tested first). Nodes are never freed; a
+ * manager lives as long as the analysis that owns it.
+ */
+class BDDManager {
+ public:
+  static constexpr BDD False = 0;
+  static constexpr BDD True = 1;
+
+  BDDManager();
+
+  /**
+     * @brief The function that is true iff variable Var is true.
+     */
+  BDD var(unsigned Var);
+
+  /**
+     * @brief The function that is true iff variable Var is false.
+     */
+  BDD nvar(unsigned Var);
+
+  BDD ite(BDD F, BDD G, BDD H);
+  BDD bddAnd(BDD F, BDD G);
+  BDD bddOr(BDD F, BDD G);
+  BDD bddNot(BDD F);
+
+  /**
+     * @brief Build the conjunction of the given variables, used as the set of
+     * variables to quantify away.
+     */
+  BDD cube(const std::vector<unsigned>& Vars);
+
+  /**
+     * @brief Existentially quantify the variables of Cube out of F.
+     */
+  BDD exists(BDD F, BDD Cube);
+
+  /**
+     * @brief Relational product: exists Cube. (F and G), computed in one pass
+     * without building the conjunction.
+     */
+  BDD relProd(BDD F, BDD G, BDD Cube);
+
+  /**
+     * @brief Rename variables of F. Map[V] is the new index of variable V;
+     * variables beyond the end of Map are left alone.
+     */
+  BDD replace(BDD F, const std::vector<unsigned>& Map);
+
+  /**
+     * @brief Enumerate the assignments to Vars that satisfy F, each read as a
+     * binary number whose most significant bit is the first of Vars. Vars
+     * must be sorted and F must not depend on any other variable.
+     */
+  std::vector<uint64_t> values(BDD F, const std::vector<unsigned>& Vars) const;
+
+  // Number of nodes allocated so far, including the two terminals
+  size_t numNodes() const;
+
+  // Memory used by nodes, the unique table and the operation cache
+  size_t memoryUsage() const;
+
+ private:
+  struct Node {
+    unsigned Var;
+    BDD Low;
+    BDD High;
+    BDD Next;  // next node in the same unique table bucket
+  };
+
+  // Entry of a lossy operation cache: a later result with the same hash
+  // simply overwrites an earlier one.
+  struct CacheEntry {
+    unsigned Op;
+    unsigned A;
+    unsigned B;
+    unsigned C;
+    BDD Result;
+  };
+
+  enum Operation : unsigned { NoOp, IteOp, ExistsOp, RelProdOp };
+
+  std::vector<Node> Nodes;
+  // Heads of the unique table buckets, chained through Node::Next
+  std::vector<BDD> Buckets;
+  std::vector<CacheEntry> Cache;
+
+  static uint64_t hash(unsigned A, unsigned B, unsigned C);
+  bool lookup(unsigned Op, unsigned A, unsigned B, unsigned C, BDD& Result) const;
+  void insert(unsigned Op, unsigned A, unsigned B, unsigned C, BDD Result);
+  void rehash();
+
+  BDD mk(unsigned Var, BDD Low, BDD High);
+  unsigned topVar(BDD F) const;
+  BDD low(BDD F, unsigned Var) const;
+  BDD high(BDD F, unsigned Var) const;
+  BDD replaceRec(BDD F, const std::vector<unsigned>& Map, std::unordered_map<BDD, BDD>& Memo);
+  void valuesRec(BDD F,
+      const std::vector<unsigned>& Vars,
+      size_t I,
+      uint64_t Prefix,
+      std::vector<uint64_t>& Result) const;
+};
+
+}  // namespace dataflow
+
+#endif  // BDD_H
@@ -0,0 +1,112 @@
+#ifndef CALL_CONTEXTS_H
+#define CALL_CONTEXTS_H
+
+#include "Domain.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Call-String Contexts
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief State of each argument of a function on entry, by position.
+ */
+using ContextInput = std::vector<Domain::Element>;
+
+/**
+ * @brief Direct call to a defined function, and the states of its arguments
+ * at the call.
+ */
+using ContextCall = std::pair<Function*, ContextInput>;
+
+/**
+ * @brief Bounded call-string context sensitivity for the dataflow passes.
+ *
+ * Without contexts, a function is analyzed once with its arguments in a
+ * default state, MaybeFreed for DoubleFree and Live for UseAfterFree. A sink
+ * shared by a good and a bad path then reports on both, or on neither. With
+ * contexts, a function whose only uses are direct calls is analyzed with the
+ * states its callers pass instead. The other functions are the roots, and
+ * are analyzed with the default state.
+ *
+ * A context is analyzed at the end of a call string of at most Depth calls
+ * from a root. The calls it makes are followed breadth-first, so the first
+ * time a context is seen it is at its shortest call string. Contexts are
+ * memoized by function and input, so the same input reached along different
+ * call strings is analyzed once. A function called at the end of a call
+ * string of Depth calls falls back to the default state, as do the callees
+ * of that fallback, and so does a function once Budget contexts have been
+ * analyzed in the module. The warnings of a function are those of all its
+ * contexts.
+ */
+class CallContexts {
+ public:
+  /**
+   * @brief Analyze F with its arguments in the states of Input. Add the
+   * instructions it reports to Errors, and its direct calls to defined
+   * functions to Calls.
+   */
+  using Solver = function_ref<void(Function& F,
+      const ContextInput& Input,
+      SetVector<Instruction*>& Errors,
+      std::vector<ContextCall>& Calls)>;
+
+  /**
+   * @param Default The state of an argument without a context, and of one
+   * whose state at the call is Uninit
+   */
+  CallContexts(Module& M, unsigned Depth, unsigned Budget, Domain::Element Default);
+
+  /**
+   * @brief Analyze every root, the contexts reached from them and the
+   * fallbacks.
+   */
+  void run(Solver Solve);
+
+  /**
+   * @brief Instructions of F reported in any of its contexts.
+   */
+  const SetVector<Instruction*>& errors(const Function& F) const;
+
+  /**
+   * @brief Print the number of contexts analyzed and their time, e.g.
+   * `DoubleFree contexts: 12 roots, 30 contexts of 8 functions (at most 6),
+   * 41 reused, 1 fallbacks, depth 2, budget 1024, 3.2 ms`.
+   */
+  void print(raw_ostream& O, StringRef What) const;
+
+ private:
+  Module& M;
+  unsigned Depth;
+  unsigned Budget;
+  Domain::Element Default;
+  // Functions only used as the callee of direct calls
+  DenseSet<const Function*> Callees;
+
+  DenseMap<const Function*, SetVector<Instruction*>> Errors;
+  // Contexts analyzed per function, the roots and fallbacks excluded
+  DenseMap<const Function*, unsigned> PerFunction;
+  unsigned Roots = 0;
+  unsigned Contexts = 0;
+  unsigned Reused = 0;
+  unsigned Fallbacks = 0;
+  double Ms = 0;
+};
+
+}  // namespace dataflow
+
+#endif  // CALL_CONTEXTS_H
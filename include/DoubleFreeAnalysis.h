@@ -1,8 +1,10 @@
 #ifndef DOUBLE_FREE_ANALYSIS_H
 #define DOUBLE_FREE_ANALYSIS_H
 
+#include "CallContexts.h"
 #include "Domain.h"
 #include "DoubleFreePointerAnalysis.h"
+#include "FunctionSummary.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
@@ -25,6 +27,11 @@ struct DoubleFreeAnalysis : public PassInfoMixin<DoubleFreeAnalysis> {
   std::map<Instruction*, Memory*> InMap;
   std::map<Instruction*, Memory*> OutMap;
   SetVector<Instruction*> ErrorInsts;
+  PointsToOptions Options;
+  // Summaries of the functions of the analyzed module, applied at direct calls
+  const FunctionSummaries* Summaries = nullptr;
+
+  DoubleFreeAnalysis(const PointsToOptions& Options = {}) : Options(Options) {}
 
   /**
    * This function is called for each module M in the input C program
@@ -41,16 +48,17 @@ struct DoubleFreeAnalysis : public PassInfoMixin<DoubleFreeAnalysis> {
   void transfer(Instruction* I,
       const Memory* In,
       Memory& NOut,
-      DoubleFreePointerAnalysis* PA,
-      SetVector<Value*> PointerSet);
+      PointsToBackend* PA);
 
   /**
    * @brief This function implements the chaotic iteration algorithm using
    * flowIn(), transfer(), and flowOut().
    *
    * @param F The function to be analyzed.
+   * @param Entry The states of the arguments of F on entry, or null for
+   * MaybeFreed.
    */
-  void doAnalysis(Function& F, DoubleFreePointerAnalysis* PA);
+  void doAnalysis(Function& F, PointsToBackend* PA, const ContextInput* Entry = nullptr);
 
   /**
    * @brief Flow the abstract domains from all predecessors of Inst into the In
@@ -81,6 +89,11 @@ struct DoubleFreeAnalysis : public PassInfoMixin<DoubleFreeAnalysis> {
    */
   bool check(Instruction* Inst);
 
+  /**
+   * @brief Print the instructions of ErrorInsts to stdout.
+   */
+  void printErrorInsts();
+
   std::string getAnalysisName() {
     return "DoubleFree";
   }
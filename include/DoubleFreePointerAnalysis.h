@@ -2,10 +2,18 @@
 #define DOUBLE_FREE_POINTER_ANALYSIS_H
 
 #include "Domain.h"
+#include "PointsToBackend.h"
+#include "PointsToSetPool.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <map>
 #include <set>
+#include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -15,15 +23,55 @@ namespace dataflow {
 // Pointer Analysis
 //===----------------------------------------------------------------------===//
 
-using PointsToSet = std::set<std::string>;
+/**
+ * @brief InternedPointsToInfo maps each variable (and each allocation site,
+ * for what is stored there) to the ID of its interned points-to set.
+ *
+ */
+using InternedPointsToInfo = std::map<std::string, SetID>;
 
 /**
- * @brief PointsToInfo represents the set of allocation sites a variable can
- * point to.
+ * @brief Metrics of the solve of one function, to find the functions whose
+ * points-to sets blow up.
+ */
+struct PointsToStats {
+  // Constraints by kind: allocation sites (arguments, allocas and calls),
+  // copies (casts, GEPs and phis), and loads and stores of pointers
+  unsigned Allocs = 0;
+  unsigned Copies = 0;
+  unsigned Loads = 0;
+  unsigned Stores = 0;
+  // Rounds over the function until no fact is added
+  unsigned Rounds = 0;
+
+  size_t Variables = 0;
+  size_t Facts = 0;
+  size_t Sets = 0;
+  size_t FieldSites = 0;
+  size_t Collapsed = 0;
+  // Histogram[0] counts the empty sets, Histogram[i] the sets with 2^(i-1)
+  // to 2^i - 1 sites
+  std::vector<unsigned> Histogram;
+  // Names and sizes of the largest sets, largest first
+  std::vector<std::pair<std::string, size_t>> Largest;
+
+  // Time of the fixpoint and of the inverse index
+  double SolveMs = 0;
+  double IndexMs = 0;
+  // Bytes held by the set pool
+  size_t PoolBytes = 0;
+};
+
+/**
+ * @brief Inclusion-based (Andersen) points-to solver of one function.
  *
+ * The solution can be kept up to date across edits of the function: an edit
+ * retracts the constraints of the instructions it erases or changes with
+ * removeInstructions(), then adds those of the instructions it inserts or
+ * changes with addInstructions(). Facts are keyed by value name, so the edit
+ * must not rename the other values (e.g. renumber unnamed ones).
  */
-using PointsToInfo = std::map<std::string, PointsToSet>;
-class DoubleFreePointerAnalysis {
+class DoubleFreePointerAnalysis : public PointsToBackend {
  public:
   /**
      * @brief Build a points-to graph
@@ -32,8 +80,12 @@ class DoubleFreePointerAnalysis {
      * on each instruction in function F.
      *
      * @param F The function for which pointer analysis is done
+     * @param MaxFields Cap on the fields of one object, see PointsToOptions
+     * @param JSONStats Print the statistics as JSON instead of the solution
      */
-  DoubleFreePointerAnalysis(Function& F);
+  DoubleFreePointerAnalysis(Function& F,
+      unsigned MaxFields = PointsToOptions::DefaultMaxFields,
+      bool JSONStats = false);
 
   /**
      * @brief If the instruction is memory allocation, store, or load, updates
@@ -42,30 +94,203 @@ class DoubleFreePointerAnalysis {
      * @param Inst The instruction to be analyzed for aliasing
      * @param PointsTo The set of
      */
-  void transfer(Instruction* Inst, PointsToInfo& PointsTo);
+  void transfer(Instruction* Inst, InternedPointsToInfo& PointsTo);
 
   /**
-     * @brief Returns true if two pointers are aliased
+     * @brief Returns true if two pointers are aliased, i.e. may point to the
+     * same site, or one to an object and the other to a field of it. Freeing
+     * an object frees its fields, but pointers to two different fields of one
+     * object do not alias.
      *
      * @param Ptr1 First pointer
      * @param Ptr2 Second pointer
      * @return bool
      */
-  bool alias(std::string& Ptr1, std::string& Ptr2) const;
+  bool alias(std::string& Ptr1, std::string& Ptr2) const override;
+
+  std::vector<std::string> aliases(const std::string& Ptr) const override;
+
+  /**
+     * @brief Retract the constraints of Insts before an edit erases them or
+     * changes their operands. Insts must still be in the function, and must
+     * include every instruction whose operands the edit changes. Every fact
+     * with a derivation through Insts is deleted, then the deleted facts that
+     * are still derivable without them are derived again (DRed), so the cost
+     * follows the affected facts rather than the size of the function.
+     *
+     * @param Insts The instructions to retract
+     */
+  void removeInstructions(ArrayRef<Instruction*> Insts);
+
+  /**
+     * @brief Add the constraints of Insts after an edit inserted them or
+     * changed their operands, and propagate the new facts.
+     *
+     * @param Insts The instructions to add
+     */
+  void addInstructions(ArrayRef<Instruction*> Insts);
+
+  /**
+     * @brief Whether the solution and its inverse index equal those of a
+     * solve from scratch of the function without the retracted instructions.
+     * The solve runs in a solver of its own, so this one is left unchanged.
+     */
+  bool verify();
+
+  // Number of instructions evaluated by the last update
+  unsigned numEvaluated() const {
+    return Evaluated;
+  }
+
+  // Metrics of the solve done by the constructor
+  const PointsToStats& stats() const {
+    return Stats;
+  }
+
+  /**
+     * @brief Print the statistics as one line of JSON
+     */
+  void printStats(raw_ostream& OS) const;
+
+  /**
+     * @brief The `STATISTIC` counters of every solve, for
+     * printPointsToStatistics()
+     */
+  static ArrayRef<TrackingStatistic*> statistics();
 
  private:
-  PointsToInfo PointsTo;
+  /**
+     * @brief Solve F from scratch without the instructions in Retracted, for
+     * verify(). The objects named in Collapsed start collapsed, since an
+     * object stays collapsed across edits. Nothing is printed or counted.
+     */
+  DoubleFreePointerAnalysis(Function& F,
+      unsigned MaxFields,
+      const std::set<Instruction*>& Retracted,
+      const std::vector<std::string>& Collapsed);
+
+  Function* Func;
+
+  InternedPointsToInfo PointsTo;
+
+  // Inverse of PointsTo over the pointer variables of the function: for each
+  // site, the variables whose points-to set contains it. Entries point to the
+  // keys of PointsTo.
+  std::vector<std::vector<const std::string*>> PointedBy;
+
+  // Owner of every points-to set in PointsTo
+  PointsToSetPool Pool;
+
+  // Cap on the fields of one object, offset 0 included
+  unsigned MaxFields;
+
+  // For each field site, the object site it belongs to and its byte offset.
+  // An object is its own field at offset 0 and has no entry.
+  std::map<SiteID, std::pair<SiteID, int64_t>> FieldOf;
+  // Field sites of each object, by offset
+  std::map<SiteID, std::map<int64_t, SiteID>> Fields;
+  // Objects merged back into one node once past the cap
+  std::set<SiteID> Collapsed;
+  // Set when an object collapses, so the fixpoint runs another round
+  bool CollapseChanged = false;
 
   // Name of the function being analyzed (used for clearer warnings)
   std::string FuncName;
 
+  // Loads and stores by the sites their pointer may point to, so that a
+  // change to what a site holds reaches the instructions that access it.
+  // Only built once the solution is updated.
+  std::map<SiteID, std::set<Instruction*>> Accessors;
+  // The sites each load and store is registered for in Accessors
+  std::map<Instruction*, SetID> Accessed;
+  bool Indexed = false;
+
+  // Instructions retracted and not added back yet; solving skips them
+  std::set<Instruction*> Retracted;
+
+  unsigned Evaluated = 0;
+
+  PointsToStats Stats;
+
   // Nullness state per variable (uses Domain::NullState values)
   std::map<std::string, dataflow::Domain::NullState> NullStates;
   // Flag set during transfer when a NullState changes (used for fixpoint)
   bool NullChanged = false;
 
-  // Compute the NullState for a variable from the PointsTo map
-  Domain::NullState computeNullState(const std::string& var, PointsToInfo& PointsTo);
+  /**
+     * @brief Get the site for Offset bytes past Site, within Site's object
+     */
+  SiteID field(SiteID Site, int64_t Offset);
+
+  /**
+     * @brief Add to Sites the sites whose pointers alias a pointer to Site:
+     * Site itself, its object if it is a field, and its fields if it is an
+     * object
+     */
+  void aliasSites(SiteID Site, std::vector<SiteID>& Sites) const;
+
+  /**
+     * @brief Merge the object of Site into one node and return it
+     */
+  SiteID collapse(SiteID Site);
+
+  /**
+     * @brief Get the site that holds the contents of Site: its object once
+     * collapsed, Site itself otherwise
+     */
+  SiteID canonical(SiteID Site) const;
+
+  /**
+     * @brief Rewrite every points-to set in terms of canonical sites, and drop
+     * the contents of the fields of collapsed objects
+     */
+  void canonicalize(InternedPointsToInfo& PointsTo);
+
+  /**
+     * @brief Byte offset of the field a GEP selects within its base object
+     */
+  static int64_t fieldOffset(GetElementPtrInst* GEP);
+
+  /**
+     * @brief Solve the constraints of the function, retracted instructions
+     * excepted, into PointsTo
+     *
+     * @return unsigned The number of rounds over the function
+     */
+  unsigned solve(InternedPointsToInfo& PointsTo);
+
+  /**
+     * @brief Fill Stats from the solution, and add it to the LLVM statistics
+     */
+  void collectStats();
+
+  /**
+     * @brief The points-to set of Name, without creating an entry
+     */
+  SetID lookup(const std::string& Name) const;
+
+  /**
+     * @brief Register a load or store in Accessors for the sites of Pointer
+     *
+     * @return SetID The sites Pointer may point to
+     */
+  SetID access(Instruction* Inst, Value* Pointer);
+
+  /**
+     * @brief Fill Accessors from the solved PointsTo
+     */
+  void buildAccessorIndex();
+
+  /**
+     * @brief Update PointedBy for the variable Name going from Old to New
+     */
+  void reindex(const std::string& Name, SetID Old, SetID New);
+
+  /**
+     * @brief Evaluate the instructions of WorkList, and those reading what
+     * they change, until nothing changes
+     */
+  void propagate(std::vector<Instruction*> WorkList);
 
   /**
      * @brief
@@ -73,14 +298,21 @@ class DoubleFreePointerAnalysis {
      * @param PointsTo
      * @return int
      */
-  int countFacts(PointsToInfo& PointsTo);
+  int countFacts(InternedPointsToInfo& PointsTo);
+
+  /**
+     * @brief Fill PointedBy from the solved PointsTo
+     *
+     * @param F The function this analysis was built for
+     */
+  void buildInverseIndex(Function& F);
 
   /**
      * @brief
      *
      * @param PointsTo
      */
-  void print(std::map<std::string, PointsToSet>& PointsTo);
+  void print(InternedPointsToInfo& PointsTo);
 };
 };  // namespace dataflow
 
@@ -0,0 +1,127 @@
+#ifndef FLOW_SENSITIVE_POINTER_ANALYSIS_H
+#define FLOW_SENSITIVE_POINTER_ANALYSIS_H
+
+#include "PointsToBackend.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/IR/Function.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Sparse Flow-Sensitive Pointer Analysis
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Staged sparse flow-sensitive points-to analysis.
+ *
+ * Pointer values are in SSA form, so only what is stored in memory needs a
+ * state per program point. A flow-insensitive inclusion pre-analysis first
+ * finds the sites every load and store may access. The memory def-use chains
+ * of MemorySSA are then refined per site: a site's value at a load comes
+ * from the closest stores that may write that site, merged at memory phis,
+ * skipping every store the pre-analysis proves unrelated. The main analysis
+ * propagates contents along those sparse edges only, killing the old
+ * contents of a site at a store that must write all of it (a strong update).
+ * Sites are objects, so a store to one field of an aggregate keeps the
+ * contents of the others.
+ */
+class FlowSensitivePointerAnalysis : public PointsToBackend {
+ public:
+  /**
+     * @brief Run the pre-analysis, build the sparse memory graph and solve it
+     *
+     * @param F The function for which pointer analysis is done
+     */
+  FlowSensitivePointerAnalysis(Function& F);
+
+  bool alias(std::string& Ptr1, std::string& Ptr2) const override;
+
+  std::vector<std::string> aliases(const std::string& Ptr) const override;
+
+  // Size of the sparse memory graph: (store or memory phi, site) nodes and
+  // the edges between them
+  size_t numMemoryNodes() const;
+  size_t numMemoryEdges() const;
+
+ private:
+  using NodeID = unsigned;
+  using SiteID = unsigned;
+  static constexpr unsigned NoNode = ~0u;
+
+  struct LoadConstraint {
+    NodeID Dst;
+    NodeID Ptr;
+    const MemoryAccess* In;
+  };
+
+  struct StoreConstraint {
+    NodeID Ptr;
+    NodeID Val;
+    const MemoryDef* Def;
+    // Sites the pointer may point to in the pre-analysis
+    SiteSet May;
+    // Whether the store overwrites all of the object, see writesWholeObject
+    bool Whole;
+  };
+
+  // A store or memory phi, for one site. In holds the sparse predecessors:
+  // the reaching definition for a store, every incoming one for a phi.
+  struct MemoryNode {
+    const MemoryAccess* Access;
+    unsigned Store;  // index in Stores, or NoNode for a phi
+    SiteID Site;
+    SmallVector<unsigned, 2> In;
+  };
+
+  // Top-level pointers
+  DenseMap<const Value*, NodeID> ValueNodes;
+  std::vector<SiteSet> PointsTo;
+
+  // Allocation sites
+  DenseMap<const Value*, SiteID> SiteIDs;
+  // Whether a site is one object at run time, so that a store to it may kill
+  // its old contents
+  std::vector<bool> Singleton;
+
+  // Constraints
+  std::vector<std::pair<NodeID, SiteID>> AddressOf;
+  std::vector<std::pair<NodeID, NodeID>> Copies;  // src -> dst
+  std::vector<LoadConstraint> Loads;
+  std::vector<StoreConstraint> Stores;
+  DenseMap<const MemoryDef*, unsigned> StoreOf;
+
+  // Sparse memory graph, the nodes reading each node, and the contents of
+  // each node
+  std::vector<MemoryNode> MemoryNodes;
+  std::vector<SmallVector<unsigned, 2>> Users;
+  std::vector<SiteSet> Contents;
+  DenseMap<std::pair<const MemoryAccess*, SiteID>, unsigned> MemoryNodeOf;
+  // Reaching definition of a site from a memory access
+  DenseMap<std::pair<const MemoryAccess*, SiteID>, unsigned> Reaching;
+  // Phis whose incoming definitions are not connected yet
+  std::vector<unsigned> PendingPhis;
+
+  // Results by the variable names the dataflow analysis uses
+  std::map<std::string, SiteSet> Names;
+  std::map<unsigned, std::vector<const std::string*>> PointedBy;
+
+  NodeID node(const Value* V);
+  SiteID site(const Value* V, bool IsSingleton);
+  void collect(Instruction* Inst, MemorySSA& MSSA);
+  void preSolve();
+  unsigned reachingDef(const MemoryAccess* Access, SiteID Site, const MemorySSA& MSSA);
+  void buildMemoryGraph(const MemorySSA& MSSA);
+  void solveMemory();
+  void solve();
+  void buildIndex(Function& F);
+};
+}  // namespace dataflow
+
+#endif  // FLOW_SENSITIVE_POINTER_ANALYSIS_H
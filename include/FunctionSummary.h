@@ -0,0 +1,234 @@
+#ifndef FUNCTION_SUMMARY_H
+#define FUNCTION_SUMMARY_H
+
+#include "PointsToBackend.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/MD5.h"
+
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+class AnalysisCache;
+class SummaryIndex;
+struct SummaryEdge;
+
+//===----------------------------------------------------------------------===//
+// Function Summaries
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief What a call to a function may do to its pointer arguments, as far
+ * as the free and use-after-free dataflow is concerned. Bit k of each vector
+ * stands for parameter k.
+ */
+struct FunctionSummary {
+  // Parameters the call may pass to free
+  BitVector Frees;
+  // Parameters the call may load from or store to, pass to a function
+  // without a summary, or store into a global
+  BitVector Derefs;
+  // Parameters the call may store into a global
+  BitVector Escapes;
+  // Every pointer the call returns is a new allocation, or null, and the call
+  // frees none of the memory it allocates
+  bool ReturnsFresh = false;
+
+  bool operator==(const FunctionSummary& Other) const {
+    return Frees == Other.Frees && Derefs == Other.Derefs && Escapes == Other.Escapes &&
+           ReturnsFresh == Other.ReturnsFresh;
+  }
+  bool operator!=(const FunctionSummary& Other) const {
+    return !(*this == Other);
+  }
+
+  void print(raw_ostream& O) const;
+
+  /**
+   * @brief Append the summary to Words: the number of parameters, ReturnsFresh,
+   * then Frees, Derefs and Escapes, 32 parameters per word.
+   */
+  void serialize(std::vector<uint32_t>& Words) const;
+
+  /**
+   * @brief Read a summary written by serialize() from the front of Words and
+   * drop what was read.
+   *
+   * @return bool False if Words is too short
+   */
+  bool deserialize(ArrayRef<uint32_t>& Words);
+};
+
+/**
+ * @brief Summaries of every defined function of a module.
+ *
+ * Summaries are computed bottom-up over the strongly connected components of
+ * the call graph, so the summaries of the callees of a function are known
+ * when it is summarized, and a call applies them without looking into the
+ * callee. The functions of a recursive component are summarized together
+ * until their summaries no longer change: the may facts start empty and
+ * grow, ReturnsFresh starts true and can only be dropped.
+ *
+ * A function is summarized from the origins of its pointer values: the
+ * parameters, fresh allocations (malloc, calloc, realloc and calls to
+ * functions that return fresh memory) and anything else. Stack slots carry
+ * the origins of the values stored into them, which follows parameters
+ * through the spills of unoptimized code. Calls to `free` and to summarized
+ * functions add the origins of their arguments to the facts. A parameter
+ * passed to any other call, such as a library function or an indirect call,
+ * counts as dereferenced, since the callee may read through it.
+ *
+ * The components and the edges between them are found on construction and
+ * summarized by the first compute(). With several threads, a component is
+ * queued on the worker that finishes the last component it calls, and idle
+ * workers steal from the others, so independent parts of the call graph are
+ * summarized concurrently. Each component only reads the finished summaries
+ * of its callees and writes its own, so the summaries are the same for any
+ * number of threads.
+ *
+ * The summaries of functions defined in other modules can be imported from a
+ * SummaryIndex before the first compute(), and are then applied at calls to
+ * them like those of the module.
+ */
+class FunctionSummaries {
+ public:
+  FunctionSummaries(Module& M);
+
+  /**
+   * @brief Summarize every function on Threads threads, 0 for one per core.
+   * Verify checks a parallel run against a sequential one. Components whose
+   * functions and callee summaries are in Cache, if any, are read from it.
+   * Only the first call does any work.
+   */
+  void compute(unsigned Threads, bool Verify = false, AnalysisCache* Cache = nullptr);
+
+  /**
+   * @brief Import the summaries in Imports of the functions the module
+   * declares. After the first compute(), Imports may only repeat summaries
+   * already imported, e.g. the same index given to two passes; anything
+   * else is a fatal error.
+   *
+   * @return unsigned Number of functions imported
+   */
+  unsigned import(const SummaryIndex& Imports);
+
+  /**
+   * @brief Add to Exports the summary of every defined function and the edges
+   * from its parameters to the arguments of its direct calls.
+   */
+  void exportTo(SummaryIndex& Exports) const;
+
+  /**
+   * @brief Summary of F, or null if F is only declared and was not imported.
+   */
+  const FunctionSummary* lookup(const Function* F) const {
+    auto It = Index.find(F);
+    return It == Index.end() ? nullptr : &Summaries[It->second];
+  }
+
+  /**
+   * @brief Whether Other holds the same summary for every function.
+   */
+  bool sameSummaries(const FunctionSummaries& Other) const;
+
+  /**
+   * @brief Whether a sequential run without a cache, with the same imports,
+   * computes the same summaries.
+   */
+  bool matchesSequential() const;
+
+  // Number of call graph components summarized, and of those with a cycle
+  unsigned numSCCs() const {
+    return SCCs.size();
+  }
+  unsigned numRecursiveSCCs() const;
+
+  bool invalidate(Module& M, const PreservedAnalyses& PA, ModuleAnalysisManager::Invalidator& Inv);
+
+ private:
+  struct SCCNode {
+    std::vector<Function*> Members;
+    bool Recursive = false;
+    // Number of other components this one calls
+    unsigned NumCallees = 0;
+    // Components calling this one, each once
+    std::vector<unsigned> Callers;
+  };
+
+  Module* M;
+  // Callees come before their callers
+  std::vector<SCCNode> SCCs;
+  // Slot of each defined function in Summaries, fixed on construction so
+  // that concurrent components never move each other's summaries
+  DenseMap<const Function*, unsigned> Index;
+  std::vector<FunctionSummary> Summaries;
+  // Declared functions whose summaries were imported
+  std::vector<const Function*> Imported;
+  bool Computed = false;
+
+  /**
+   * @brief Summarize the members of a component, whose callees are done.
+   */
+  void summarizeSCC(const SCCNode& SCC, AnalysisCache* Cache);
+
+  /**
+   * @brief Summarize every component on Threads work-stealing workers, each
+   * one once the components it calls are done.
+   */
+  void summarizeParallel(unsigned Threads, AnalysisCache* Cache);
+
+  /**
+   * @brief Cache key of a component: the structure of its functions and the
+   * summaries of the functions they call outside of it.
+   */
+  MD5::MD5Result cacheKey(const SCCNode& SCC) const;
+
+  /**
+   * @brief Summarize F from the current summaries of its callees, and add to
+   * Edges, if given, the edges of its direct calls.
+   */
+  FunctionSummary summarize(Function& F, std::vector<SummaryEdge>* Edges = nullptr) const;
+};
+
+/**
+ * @brief Module analysis computing the FunctionSummaries of a module, shared
+ * by the DoubleFree and UseAfterFree passes of a pipeline as long as the
+ * loader binds the key of both plugins to one symbol, see
+ * src/AnalysisKeys.cpp.
+ */
+class FunctionSummaryAnalysis : public AnalysisInfoMixin<FunctionSummaryAnalysis> {
+  friend AnalysisInfoMixin<FunctionSummaryAnalysis>;
+  static AnalysisKey Key;
+
+ public:
+  using Result = FunctionSummaries;
+
+  Result run(Module& M, ModuleAnalysisManager& AM);
+};
+
+/**
+ * @brief Print the summary of every defined function and the time taken to
+ * compute them, registered as `FunctionSummary` with the `threads=N`,
+ * `verify`, `cache=DIR` and `index=FILE` parameters of the points-to passes.
+ * With `emit=FILE`, it also writes them to FILE as the SummaryIndex of the
+ * module, to be linked with those of other modules.
+ */
+struct FunctionSummaryPrinter : public PassInfoMixin<FunctionSummaryPrinter> {
+  // Threads, Verify, CacheDir, IndexFile and EmitFile are used
+  PointsToOptions Options;
+
+  FunctionSummaryPrinter(const PointsToOptions& Options = {}) : Options(Options) {}
+
+  PreservedAnalyses run(Module& M, ModuleAnalysisManager& AM);
+};
+
+}  // namespace dataflow
+
+#endif  // FUNCTION_SUMMARY_H
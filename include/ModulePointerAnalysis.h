@@ -0,0 +1,207 @@
+#ifndef MODULE_POINTER_ANALYSIS_H
+#define MODULE_POINTER_ANALYSIS_H
+
+#include "PointsToBackend.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+class ModulePointsToView;
+
+//===----------------------------------------------------------------------===//
+// Whole-Module Pointer Analysis
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Inclusion-based points-to analysis of a whole module.
+ *
+ * Every pointer value of the module is a node of one constraint graph and
+ * every allocation site (alloca, call to an external function, global,
+ * function, argument of a function with unknown callers) has an object node
+ * for what is stored in it. Actual arguments flow into formals and returned
+ * values into call results, so allocation sites keep their identity across
+ * helpers and wrappers. Indirect calls are resolved while solving, as
+ * function addresses reach the called pointer: the call graph is built on
+ * the fly. The module is solved once with a difference-propagation worklist.
+ *
+ * Before solving, pointer equivalent nodes are merged offline (hash-based
+ * value numbering): every node gets a label from the labels of its incoming
+ * copy edges and the sites it takes the address of, and nodes with the same
+ * label must end up with the same points-to set. Cast chains, single-source
+ * phis and GEPs of one pointer thus collapse onto one node, as do copy
+ * cycles. Nodes that may gain edges while solving (loaded values, objects,
+ * formals of address-taken functions, results of indirect calls) get labels
+ * of their own.
+ */
+class ModulePointerAnalysis {
+ public:
+  using NodeID = unsigned;
+  using SiteID = unsigned;
+
+  /**
+     * @brief Build the constraint graph of M. Queries need a solve() first.
+     *
+     * @param M The module to analyze
+     */
+  ModulePointerAnalysis(Module& M);
+
+  /**
+     * @brief Solve the constraint graph; does nothing once solved
+     *
+     * @param Verify If nodes were merged, also solve the module without
+     * reduction and abort if the solutions differ
+     * @param Reduce Merge pointer equivalent nodes first, see reduce()
+     */
+  void solve(bool Verify = false, bool Reduce = true);
+
+  /**
+     * @brief Merge the nodes the offline value numbering proves pointer
+     * equivalent; does nothing once done or once solving started. solve()
+     * calls it, calling it first only times it apart.
+     */
+  void reduce();
+
+  /**
+     * @brief Whether every value points to the same allocation sites in both
+     * solutions. Site IDs depend on the order calls are resolved in, so the
+     * sites are compared by the values they were created for.
+     */
+  bool sameSolution(const ModulePointerAnalysis& Other) const;
+
+  /**
+     * @brief The sites V may point to; empty if V is not a pointer the
+     * analysis knows about.
+     */
+  const SiteSet& pointsTo(const Value* V) const;
+
+  /**
+     * @brief The per-function query interface used by the dataflow passes.
+     * Built on first use and owned by this analysis.
+     */
+  ModulePointsToView& function(Function& F);
+
+  // Value a site was created for
+  const Value* siteValue(SiteID Site) const;
+
+  // Size of the constraint graph and of the resolved call graph
+  size_t numNodes() const;
+  size_t numSites() const;
+  size_t numCallEdges() const;
+  // Nodes merged into another one by reduce()
+  size_t numMerged() const;
+
+  /**
+     * @brief The solution depends on every function of the module, so it
+     * stays valid only when a pass preserves this analysis or all module
+     * analyses.
+     */
+  bool invalidate(Module& M, const PreservedAnalyses& PA, ModuleAnalysisManager::Invalidator& Inv);
+
+ private:
+  static constexpr NodeID NoNode = ~0u;
+
+  Module& M;
+  bool Solved = false;
+  bool Reduced = false;
+  size_t Merged = 0;
+
+  DenseMap<const Value*, NodeID> ValueNodes;
+  // Node each node was merged into, itself if it was not
+  std::vector<NodeID> Rep;
+  std::vector<const Value*> SiteValues;
+  // Object node holding the contents of each site
+  std::vector<NodeID> ObjectNodes;
+  DenseMap<SiteID, const Function*> FunctionSites;
+
+  // Constraints, by node
+  std::vector<SiteSet> PointsTo;
+  std::vector<SiteSet> Propagated;      // part of PointsTo already pushed along edges
+  std::vector<SmallVector<NodeID, 2>> Copies;   // n -> dst: pts(dst) |= pts(n)
+  std::vector<SmallVector<NodeID, 1>> Loads;    // dst = *n
+  std::vector<SmallVector<NodeID, 1>> Stores;   // *n = src
+  DenseSet<std::pair<NodeID, NodeID>> Edges;
+  DenseMap<NodeID, SmallVector<const CallBase*, 1>> IndirectCalls;
+  DenseMap<const Function*, SmallVector<NodeID, 1>> Returns;
+  DenseSet<std::pair<const CallBase*, const Function*>> CallEdges;
+  // Address-of constraints, kept for the labels of reduce()
+  std::vector<std::pair<NodeID, SiteID>> Addresses;
+
+  std::vector<NodeID> WorkList;
+  std::vector<bool> InWorkList;
+
+  std::map<const Function*, std::unique_ptr<ModulePointsToView>> Views;
+
+  NodeID newNode();
+  NodeID node(const Value* V);
+  SiteID site(const Value* V);
+  void addressOf(NodeID N, SiteID Site);
+  void addCopy(NodeID Src, NodeID Dst);
+  void push(NodeID N);
+
+  void collectGlobal(GlobalVariable& G);
+  void collectFunction(Function& F);
+  void collectInstruction(Instruction* Inst);
+  void connectCall(const CallBase* Call, const Function* Callee);
+  void addCalls(NodeID N, SiteID Site);
+  void propagate();
+};
+
+/**
+ * @brief Queries on one function of a solved ModulePointerAnalysis, by the
+ * variable names the dataflow analysis uses.
+ */
+class ModulePointsToView : public PointsToBackend {
+ public:
+  ModulePointsToView(const ModulePointerAnalysis& Solution, Function& F);
+
+  /**
+     * @brief Query a solution of F's whole module computed just for F; used
+     * when no module analysis manager is at hand. Owned must be solved.
+     */
+  ModulePointsToView(std::unique_ptr<ModulePointerAnalysis> Owned, Function& F);
+
+  bool alias(std::string& Ptr1, std::string& Ptr2) const override;
+
+  std::vector<std::string> aliases(const std::string& Ptr) const override;
+
+ private:
+  std::unique_ptr<ModulePointerAnalysis> Owned;
+  // Sites of each pointer variable of the function
+  std::map<std::string, SiteSet> PointsTo;
+  // For each site, the pointer variables of the function that may point to it
+  std::map<unsigned, std::vector<const std::string*>> PointedBy;
+
+  void build(const ModulePointerAnalysis& Solution, Function& F);
+};
+
+/**
+ * @brief Module analysis computing a ModulePointerAnalysis, cached in the
+ * module analysis manager for every pass that uses the `module` backend. The
+ * constraint graph is built here and solved by the first pass that queries
+ * it.
+ */
+class ModulePointsToAnalysis : public AnalysisInfoMixin<ModulePointsToAnalysis> {
+  friend AnalysisInfoMixin<ModulePointsToAnalysis>;
+  static AnalysisKey Key;
+
+ public:
+  using Result = ModulePointerAnalysis;
+
+  Result run(Module& M, ModuleAnalysisManager& AM);
+};
+
+}  // namespace dataflow
+
+#endif  // MODULE_POINTER_ANALYSIS_H
@@ -0,0 +1,106 @@
+#ifndef NULL_DATAFLOW_ANALYSIS_H
+#define NULL_DATAFLOW_ANALYSIS_H
+
+#include "Domain.h"
+#include "PointerAnalysis.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Passes/PassBuilder.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Flow-Sensitive Nullness Analysis
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Nullness of every cell at one program point, indexed by cell ID.
+ * Unknown is the bottom of the lattice.
+ */
+using NullMemory = std::vector<Domain::NullState>;
+
+/*
+ * Forward dataflow over Null/NotNull/MaybeNull, with the chaotic iteration of
+ * DoubleFreeAnalysis and UseAfterFreeAnalysis run over basic blocks. Pointer
+ * registers and memory locations (the cells) get a state per program point: a
+ * store of null to a stack slot overwrites what the slot held, and a branch on
+ * `icmp eq/ne p, null` refines p, and the slot p was loaded from, on each
+ * outgoing edge. The flow-insensitive PointerAnalysis only names the
+ * locations each load and store may access, once before the iteration.
+ */
+struct NullDataflowAnalysis : public PassInfoMixin<NullDataflowAnalysis> {
+  // Memories at the entry and the exit of each block
+  std::map<BasicBlock*, NullMemory> InMap;
+  std::map<BasicBlock*, NullMemory> OutMap;
+  SetVector<Instruction*> ErrorInsts;
+
+  PreservedAnalyses run(Module& M, ModuleAnalysisManager& AM);
+
+ protected:
+  // Cell of each pointer register, and of each memory location by name
+  DenseMap<const Value*, unsigned> ValueCells;
+  std::map<std::string, unsigned> LocationCells;
+  unsigned NumCells = 0;
+
+  // Cells each load and store may access, and whether a store to them
+  // overwrites the only object they stand for
+  DenseMap<const Instruction*, std::vector<unsigned>> Targets;
+  DenseMap<const Instruction*, bool> StrongUpdate;
+
+  /**
+   * @brief Number the cells of F and the locations of every load and store.
+   */
+  void collectCells(Function& F, const PointerAnalysis& PA);
+
+  /**
+   * @brief Nullness of a pointer operand in Mem.
+   */
+  Domain::NullState evalNull(const NullMemory& Mem, const Value* V) const;
+
+  /**
+   * @brief Update Mem in place across instruction I.
+   */
+  void transfer(Instruction* I, NullMemory& Mem);
+
+  /**
+   * @brief Chaotic iteration over the blocks of F with flowIn(), transfer()
+   * and flowOut().
+   */
+  void doAnalysis(Function& F);
+
+  /**
+   * @brief Join the Out memories of the predecessors of BB into InMem, each
+   * one first refined by the branch leading to BB.
+   */
+  void flowIn(BasicBlock* BB, NullMemory& InMem);
+
+  /**
+   * @brief Store Post as the Out memory of BB and add its successors to the
+   * WorkSet if it changed.
+   */
+  void flowOut(BasicBlock* BB, NullMemory& Post, SetVector<BasicBlock*>& WorkSet);
+
+  /**
+   * @brief Refine Mem by the null check, if any, that Pred branches to Succ on.
+   */
+  void refineEdge(BasicBlock* Pred, BasicBlock* Succ, NullMemory& Mem);
+
+  /**
+   * @brief Does Inst dereference a pointer that may be null in Mem?
+   */
+  bool check(Instruction* Inst, const NullMemory& Mem) const;
+
+  std::string getAnalysisName() {
+    return "NullDataflow";
+  }
+};
+
+}  // namespace dataflow
+
+#endif  // NULL_DATAFLOW_ANALYSIS_H
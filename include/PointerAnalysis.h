@@ -2,11 +2,17 @@
 #define POINTER_ANALYSIS_H
 
 #include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "Domain.h"
+#include "SmallSiteSet.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
 
 using namespace llvm;
 
@@ -16,7 +22,7 @@ namespace dataflow {
 // Pointer Analysis
 //===----------------------------------------------------------------------===//
 
-using PointsToSet = std::set<std::string>;
+using PointsToSet = SmallSiteSet;
 
 /**
  * @brief PointsToInfo represents the set of allocation sites a variable can
@@ -25,8 +31,7 @@ using PointsToSet = std::set<std::string>;
  */
 using PointsToInfo = std::map<std::string, PointsToSet>;
 
-// Set of pointer variable names that are known NotNull in a given context
-using GuardedPtrSet = std::set<std::string>;
+class NullPointsToAnalysis;
 
 class PointerAnalysis {
    public:
@@ -58,9 +63,40 @@ class PointerAnalysis {
      */
     bool alias(std::string& Ptr1, std::string& Ptr2) const;
 
+    /**
+     * @brief Names of the memory locations Ptr may point to, the null
+     * pointer left out.
+     */
+    std::vector<std::string> pointees(const Value* Ptr) const;
+
+    /**
+     * @brief Print the points-to sets and the nullness summary, and warn about
+     * every dereference of a pointer that may be null.
+     *
+     * @param F The function this analysis was built for
+     */
+    void report(Function& F);
+
+    /**
+     * @brief The result only depends on the instructions of the function, so
+     * it stays valid when a pass preserves NullPointsToAnalysis or all
+     * function analyses.
+     */
+    bool invalidate(Function& F, const PreservedAnalyses& PA,
+                    FunctionAnalysisManager::Invalidator& Inv);
+
    private:
     PointsToInfo PointsTo;
 
+    // Names of the allocation sites, indexed by the site IDs of PointsToSet
+    std::vector<std::string> SiteNames;
+    std::map<std::string, SiteID> SiteIDs;
+    // The site standing for the null pointer, created first
+    static constexpr SiteID NullSite = PointsToSet::NullSite;
+
+    // Get the ID of the site called Name, creating it if needed
+    SiteID site(const std::string& Name);
+
     // Name of the function being analyzed (used for clearer warnings)
     std::string FuncName;
 
@@ -69,19 +105,26 @@ class PointerAnalysis {
     // Flag set during transfer when a NullState changes (used for fixpoint)
     bool NullChanged = false;
 
-    // Per-basic-block set of pointers guarded by null checks
-    // If a pointer is in GuardedNotNull[BB], it's known NotNull in BB
-    std::map<BasicBlock*, GuardedPtrSet> GuardedNotNull;
+    // Dominator tree of the function, built by the first guard query, so
+    // functions without a suspicious dereference never pay for it
+    std::unique_ptr<DominatorTree> DT;
+    // Memoized guard queries: whether a pointer is known NotNull in a block
+    DenseMap<std::pair<const Value*, const BasicBlock*>, bool> GuardedIn;
 
-    // Compute the NullState for a variable from the PointsTo map
-    Domain::NullState computeNullState(const std::string& var,
-                                       PointsToInfo& PointsTo);
+    // Compute the NullState of a points-to set
+    static Domain::NullState computeNullState(const PointsToSet& Pts);
 
-    // Analyze null-check branches and populate GuardedNotNull
-    void analyzeNullGuards(Function& F);
+    // Set the NullState of Var from its points-to set Pts, noting a change
+    void updateNullState(const std::string& Var, const PointsToSet& Pts);
 
     // Check if a pointer is guarded (known NotNull) at a given instruction
-    bool isGuardedNotNull(const std::string& ptrVar, Instruction* Inst);
+    bool isGuardedNotNull(const Value* Ptr, Instruction* Inst);
+
+    // Whether a null check on Ptr dominates BB with its not-null edge
+    bool isGuardedIn(const Value* Ptr, BasicBlock* BB);
+
+    // Whether the edge Pred -> Succ is the not-null edge of a check on Ptr
+    bool isNotNullEdge(const Value* Ptr, BasicBlock* Pred, BasicBlock* Succ);
 
     /**
      * @brief
@@ -98,6 +141,30 @@ class PointerAnalysis {
      */
     void print(std::map<std::string, PointsToSet>& PointsTo);
 };
+
+/**
+ * @brief Function analysis wrapping PointerAnalysis, so the solution of a
+ * function is computed once and reused by every pass of the pipeline that
+ * asks for it.
+ */
+class NullPointsToAnalysis : public AnalysisInfoMixin<NullPointsToAnalysis> {
+    friend AnalysisInfoMixin<NullPointsToAnalysis>;
+    static AnalysisKey Key;
+
+   public:
+    using Result = PointerAnalysis;
+
+    Result run(Function& F, FunctionAnalysisManager& AM) {
+        return PointerAnalysis(F);
+    }
+};
+
+inline bool PointerAnalysis::invalidate(
+    Function& F, const PreservedAnalyses& PA,
+    FunctionAnalysisManager::Invalidator& Inv) {
+    auto PAC = PA.getChecker<NullPointsToAnalysis>();
+    return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Function>>());
+}
 };  // namespace dataflow
 
 #endif  // POINTER_ANALYSIS_H
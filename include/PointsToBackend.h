@@ -0,0 +1,290 @@
+#ifndef POINTS_TO_BACKEND_H
+#define POINTS_TO_BACKEND_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SparseBitVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+// Set of allocation sites, by site ID, of the module and flow-sensitive
+// solvers
+using SiteSet = SparseBitVector<>;
+
+//===----------------------------------------------------------------------===//
+// Points-to Backend Interface
+//===----------------------------------------------------------------------===//
+
+/*
+ * Points-to solver used by the free/use-after-free dataflow.
+ * * `Andersen` - Inclusion-based solver (DoubleFreePointerAnalysis), precise
+ * * `Steensgaard` - Unification-based solver, near-linear but coarser
+ * * `Prefilter` - Run Steensgaard first and only fall back to Andersen when
+ *   some freed pointer may alias another pointer in the function
+ * * `BDD` - Inclusion-based solver over a BDD-encoded relation,
+ *   field-insensitive
+ * * `Module` - Inclusion-based solver over the whole module
+ *   (ModulePointerAnalysis), following pointers through calls
+ * * `FlowSensitive` - Sparse flow-sensitive solver over MemorySSA
+ *   (FlowSensitivePointerAnalysis)
+ */
+enum class PointsToMode {
+  Andersen,
+  Steensgaard,
+  Prefilter,
+  BDD,
+  Module,
+  FlowSensitive
+};
+
+/**
+ * @brief Solver selection of a pass, from its `Pass<...>` parameters.
+ *
+ * MaxFields caps the fields the `andersen` solver keeps apart in one object,
+ * offset 0 included; an object past the cap is collapsed to a single node.
+ * 0 or 1 makes the solver field-insensitive.
+ * The other solvers are field-insensitive.
+ *
+ * Threads is the number of threads of the function summaries, 0 for one per
+ * core. Verify makes them check a parallel result against a sequential one,
+ * and the `module` solver a reduced result against an unreduced one.
+ *
+ * Reduce merges pointer equivalent nodes of the `module` solver before it
+ * solves; `noreduce` turns that off. None of these options changes the
+ * answers.
+ *
+ * Edits is the number of instructions per function the benchmark retracts
+ * and adds back through the incremental updates of the `andersen` solver;
+ * with Verify, each update is checked against a solve from scratch.
+ *
+ * Stats makes the `andersen` solver print its statistics as one line of JSON
+ * per function instead of its solution.
+ *
+ * CacheDir, if set, is the directory of the AnalysisCache in which the
+ * dataflow passes keep their warnings and the function summaries across
+ * runs. It changes no answer either, so the solvers ignore it and it is not
+ * part of the ordering.
+ *
+ * IndexFile, if set, is a linked SummaryIndex whose summaries of functions
+ * defined in other modules are imported before summarizing. EmitFile, if set,
+ * is where the `FunctionSummary` pass writes the summaries of the module for
+ * linking. The solvers ignore both, so they are not part of the ordering.
+ *
+ * ContextDepth, if not 0, makes the dataflow passes analyze each function in
+ * the calling contexts of call strings of up to that many calls, and at most
+ * ContextBudget contexts per module, see CallContexts. The points-to solvers
+ * are per function and ignore both.
+ */
+struct PointsToOptions {
+  static constexpr unsigned DefaultMaxFields = 8;
+  static constexpr unsigned DefaultContextBudget = 1024;
+
+  PointsToMode Mode = PointsToMode::Andersen;
+  unsigned MaxFields = DefaultMaxFields;
+  unsigned Threads = 1;
+  bool Verify = false;
+  unsigned Edits = 0;
+  bool Stats = false;
+  bool Reduce = true;
+  std::string CacheDir;
+  std::string IndexFile;
+  std::string EmitFile;
+  unsigned ContextDepth = 0;
+  unsigned ContextBudget = DefaultContextBudget;
+
+  bool operator<(const PointsToOptions& Other) const {
+    return std::tie(Mode, MaxFields, Threads, Verify, Edits, Stats, Reduce) <
+           std::tie(Other.Mode, Other.MaxFields, Other.Threads, Other.Verify, Other.Edits,
+               Other.Stats, Other.Reduce);
+  }
+};
+
+/**
+ * @brief Common query interface shared by all points-to solvers. The dataflow
+ * transfer functions only ever talk to a solver through this class.
+ */
+class PointsToBackend {
+ public:
+  virtual ~PointsToBackend() = default;
+
+  /**
+     * @brief Returns true if two pointers are aliased
+     *
+     * @param Ptr1 First pointer
+     * @param Ptr2 Second pointer
+     * @return bool
+     */
+  virtual bool alias(std::string& Ptr1, std::string& Ptr2) const = 0;
+
+  /**
+     * @brief Returns every pointer variable that may alias Ptr, i.e. the
+     * pointers for which alias(Ptr, V) holds, Ptr itself excluded. The cost
+     * follows the number of aliases, not the size of the function.
+     *
+     * @param Ptr The pointer
+     * @return std::vector<std::string> Names of the aliasing pointers
+     */
+  virtual std::vector<std::string> aliases(const std::string& Ptr) const = 0;
+
+  /**
+     * @brief Memoized aliases() on an IR value. Answers are kept for the
+     * lifetime of this solver, i.e. of the analysis of one function, so a
+     * repeated query skips naming the value and the solver lookups. The
+     * reference is valid until the next call.
+     *
+     * The transfer functions never ask whether two given pointers alias, only
+     * which pointers alias a freed one, so the answers are memoized per value
+     * rather than per pair: one entry answers alias(V, W) for every W.
+     *
+     * @param V The pointer
+     * @return const std::vector<std::string>& Names of the aliasing pointers
+     */
+  const std::vector<std::string>& aliasesOf(const Value* V);
+
+  // Number of memoized queries answered from the cache / by the solver
+  unsigned cacheHits() const {
+    return CacheHits;
+  }
+  unsigned cacheMisses() const {
+    return CacheMisses;
+  }
+
+ protected:
+  /**
+     * @brief Names of the pointer-typed arguments and instructions of F, i.e.
+     * the pointers whose state the dataflow analysis tracks.
+     */
+  static std::set<std::string> pointerVariables(Function& F);
+
+  /**
+     * @brief Forget the memoized answers, once the solution has changed
+     */
+  void clearAliasCache();
+
+ private:
+  DenseMap<const Value*, std::vector<std::string>> AliasesCache;
+  unsigned CacheHits = 0;
+  unsigned CacheMisses = 0;
+};
+
+/**
+ * @brief Build the points-to solver selected by Options for function F.
+ *
+ * @param F The function for which pointer analysis is done
+ * @param Options The solver to use
+ * @return PointsToBackend* Newly allocated solver, owned by the caller
+ */
+PointsToBackend* createPointsToBackend(Function& F, const PointsToOptions& Options);
+
+/**
+ * @brief Print the statistics of the points-to solvers under `opt -stats`,
+ * then zero them. Release builds of LLVM never print statistics at exit, so
+ * each pass prints those of the solves it ran; elsewhere this does nothing.
+ * Only the counters of this plugin are printed and zeroed, so those of the
+ * other passes in the pipeline are left to LLVM.
+ */
+void printPointsToStatistics();
+
+/**
+ * @brief Get the cached solver selected by Options for F: the view of F in
+ * the module analysis for `Module`, the function analysis otherwise.
+ *
+ * @param F The function for which pointer analysis is done
+ * @param Options The solver to use
+ * @param AM The module analysis manager of the running pass
+ * @return PointsToBackend& Solver owned by the analysis manager
+ */
+PointsToBackend& getPointsToBackend(
+    Function& F, const PointsToOptions& Options, ModuleAnalysisManager& AM);
+
+/**
+ * @brief Function analysis that owns the points-to solvers of a function.
+ *
+ * Passes get a solver with
+ * `FAM.getResult<PointsToAnalysis>(F).get(Options)`, so every pass of the
+ * same opt pipeline shares one solution per function and options instead of
+ * solving again. Solvers are only built on first request. Passes of the two
+ * plugins share it only as src/AnalysisKeys.cpp describes.
+ */
+class PointsToAnalysis : public AnalysisInfoMixin<PointsToAnalysis> {
+  friend AnalysisInfoMixin<PointsToAnalysis>;
+  static AnalysisKey Key;
+
+ public:
+  class Result {
+   public:
+    Result(Function& F) : F(&F) {}
+
+    /**
+     * @brief Get the solver for Options, solving the function on first use.
+     */
+    PointsToBackend& get(const PointsToOptions& Options);
+
+    /**
+     * @brief The solution is derived from the instructions of the function
+     * alone, so it stays valid exactly when a pass preserves this analysis
+     * or all analyses on functions.
+     */
+    bool invalidate(Function& F,
+        const PreservedAnalyses& PA,
+        FunctionAnalysisManager::Invalidator& Inv);
+
+    /**
+     * @brief Forward an edit of F to the solvers, see
+     * DoubleFreePointerAnalysis::removeInstructions. The `andersen` solvers
+     * are updated in place and the others dropped, to be solved again on
+     * next use; a pass making the edit can then preserve this analysis.
+     */
+    void removeInstructions(ArrayRef<Instruction*> Insts);
+    void addInstructions(ArrayRef<Instruction*> Insts);
+
+   private:
+    Function* F;
+    std::map<PointsToOptions, std::unique_ptr<PointsToBackend>> Backends;
+  };
+
+  Result run(Function& F, FunctionAnalysisManager& AM);
+};
+
+/**
+ * @brief Parse a pipeline element of the form `Pass` or `Pass<params>`, where
+ * params is a `;`-separated list of a mode (`andersen`, `steensgaard`,
+ * `prefilter`, `bdd`, `module` or `flowsensitive`), `fields=N`, `threads=N`,
+ * `verify`, `edits=N`, `stats`, `noreduce`, `cache=DIR`, `index=FILE`,
+ * `emit=FILE`, `context=K` and `budget=N`.
+ *
+ * @param Name The pipeline element given to -passes
+ * @param PassName The registered name of the pass
+ * @param Options Set to the requested options on success
+ * @return true if Name names the pass with valid parameters
+ */
+bool parsePointsToOptions(StringRef Name, StringRef PassName, PointsToOptions& Options);
+
+/**
+ * @brief Benchmark pass: runs only the selected points-to solver on every
+ * function and reports its running time, without the dataflow analysis.
+ * Registered as `PointsTo<mode>`.
+ */
+struct PointsToBenchmark : public PassInfoMixin<PointsToBenchmark> {
+  PointsToOptions Options;
+
+  PointsToBenchmark(const PointsToOptions& Options) : Options(Options) {}
+
+  PreservedAnalyses run(Module& M, ModuleAnalysisManager& AM);
+};
+
+}  // namespace dataflow
+
+#endif  // POINTS_TO_BACKEND_H
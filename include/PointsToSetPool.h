@@ -0,0 +1,118 @@
+#ifndef POINTS_TO_SET_POOL_H
+#define POINTS_TO_SET_POOL_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Interned Points-to Sets
+//===----------------------------------------------------------------------===//
+
+// Allocation sites and points-to sets are referred to by dense IDs.
+using SiteID = unsigned;
+using SetID = unsigned;
+
+/**
+ * @brief Hash-consing table of immutable points-to sets.
+ *
+ * Every distinct set of allocation sites is stored exactly once, as a sorted
+ * vector of site IDs, and is named by its SetID. Two variables with the same
+ * points-to set therefore share one representation and copying a set is just
+ * copying its ID. Union, intersection and difference results are memoized on
+ * the pair of operand IDs. Unions and overlap tests run on the vector kernels
+ * of SiteSetKernels.h.
+ */
+class PointsToSetPool {
+ public:
+  static constexpr SetID Empty = 0;
+
+  PointsToSetPool();
+
+  /**
+     * @brief Get the ID of the allocation site called Name, creating it if
+     * needed.
+     */
+  SiteID site(const std::string& Name);
+
+  /**
+     * @brief Get the name of a site.
+     */
+  const std::string& siteName(SiteID Site) const;
+
+  // Number of allocation sites created so far
+  size_t numSites() const;
+
+  /**
+     * @brief Get the set containing just Site.
+     */
+  SetID singleton(SiteID Site);
+
+  /**
+     * @brief Get the set of the given sites, in any order and possibly
+     * repeated. Cheaper than a chain of unions for building a whole set.
+     */
+  SetID fromSites(std::vector<SiteID> Sites);
+
+  /**
+     * @brief Get the union of two sets.
+     */
+  SetID setUnion(SetID A, SetID B);
+
+  /**
+     * @brief Get the intersection of two sets.
+     */
+  SetID setIntersection(SetID A, SetID B);
+
+  /**
+     * @brief Whether two sets share a site. Neither allocates nor memoizes,
+     * so it is cheaper than testing setIntersection for Empty.
+     */
+  bool intersects(SetID A, SetID B) const;
+
+  /**
+     * @brief Get the sites of A that are not in B.
+     */
+  SetID setDifference(SetID A, SetID B);
+
+  /**
+     * @brief Get the sorted site IDs of a set. The reference is invalidated
+     * when a new set is interned.
+     */
+  const std::vector<SiteID>& elements(SetID Set) const;
+
+  size_t size(SetID Set) const;
+
+  // Number of distinct sets interned so far (including the empty set)
+  size_t numSets() const;
+
+  // Approximate bytes held by the sets, sites and memoized results
+  size_t memoryUsage() const;
+
+ private:
+  // Interned sets, indexed by SetID
+  std::vector<std::vector<SiteID>> Sets;
+  // Hash of a set's elements to the IDs of the sets with that hash
+  std::unordered_multimap<uint64_t, SetID> Index;
+
+  std::map<std::string, SiteID> SiteIDs;
+  std::vector<std::string> SiteNames;
+
+  // Memoized results, keyed by the (unordered) pair of operand IDs; the
+  // difference is keyed by the ordered pair
+  std::unordered_map<uint64_t, SetID> UnionCache;
+  std::unordered_map<uint64_t, SetID> IntersectionCache;
+  std::unordered_map<uint64_t, SetID> DifferenceCache;
+
+  SetID intern(std::vector<SiteID>&& Elems);
+  static uint64_t hash(const std::vector<SiteID>& Elems);
+  static uint64_t pairKey(SetID A, SetID B);
+};
+
+}  // namespace dataflow
+
+#endif  // POINTS_TO_SET_POOL_H
@@ -0,0 +1,51 @@
+#ifndef SITE_SET_KERNELS_H
+#define SITE_SET_KERNELS_H
+
+#include "PointsToSetPool.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Sorted Site Array Kernels
+//===----------------------------------------------------------------------===//
+
+/*
+ * Set operations on sorted, duplicate-free arrays of site IDs, the
+ * representation of the interned sets of PointsToSetPool. On x86 the kernels
+ * pick AVX2 or SSE4.1 code at run time and fall back to scalar merges
+ * elsewhere.
+ */
+
+/**
+ * @brief Whether A and B share a site. Stops at the first common site and
+ * never allocates. Blocks of 8 (AVX2) or 4 (SSE4.1) sites are compared all
+ * against all; a much smaller set is instead searched for in the larger one.
+ */
+bool sortedIntersects(const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB);
+
+inline bool sortedIntersects(const std::vector<SiteID>& A, const std::vector<SiteID>& B) {
+  return sortedIntersects(A.data(), A.size(), B.data(), B.size());
+}
+
+/**
+ * @brief Replace Result with the union of A and B, merged 4 sites at a time
+ * with a bitonic network (SSE4.1).
+ */
+void sortedUnion(const std::vector<SiteID>& A, const std::vector<SiteID>& B,
+    std::vector<SiteID>& Result);
+
+// Instruction set the kernels run with: "avx2", "sse4.1" or "scalar"
+const char* siteSetKernelISA();
+
+/**
+ * @brief Force the scalar kernels (or allow the vector ones again), so that
+ * benchmarks can compare them on one machine.
+ */
+void setScalarSiteSetKernels(bool Scalar);
+
+}  // namespace dataflow
+
+#endif  // SITE_SET_KERNELS_H
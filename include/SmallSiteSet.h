@@ -0,0 +1,153 @@
+#ifndef SMALL_SITE_SET_H
+#define SMALL_SITE_SET_H
+
+#include "PointsToSetPool.h"
+#include "llvm/ADT/BitVector.h"
+
+#include <cstddef>
+#include <iterator>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Small Site Sets
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Mutable set of allocation sites, optimized for the one or two sites
+ * most pointers have.
+ *
+ * Up to InlineCapacity sites are kept sorted in the set itself, so small sets
+ * need no heap allocation and their operations are a few compares. A set that
+ * grows past that spills to a bit vector indexed by site ID. Sets never
+ * shrink, so a set is spilled exactly when it holds more than InlineCapacity
+ * sites.
+ *
+ * Site 0 is reserved for the null pointer. As the smallest site it is either
+ * the first inline site or bit 0, so the null state of a set is two tests.
+ *
+ * Only the null pointer solvers (PointerAnalysis) use these sets. The double
+ * free and use-after-free solvers keep the interned sets of PointsToSetPool:
+ * there a variable holds a set ID, equal sets are stored once and unions are
+ * memoized, so an inline copy per variable would give up that sharing.
+ */
+class SmallSiteSet {
+ public:
+  static constexpr unsigned InlineCapacity = 4;
+  static constexpr SiteID NullSite = 0;
+
+  class iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = SiteID;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const SiteID*;
+    using reference = SiteID;
+
+    iterator(const SmallSiteSet* Set, int Pos) : Set(Set), Pos(Pos) {}
+
+    SiteID operator*() const {
+      return Set->isSpilled() ? SiteID(Pos) : Set->Inline[Pos];
+    }
+
+    iterator& operator++() {
+      if (Set->isSpilled())
+        Pos = Set->Bits.find_next(Pos);
+      else if (++Pos == int(Set->Size))
+        Pos = -1;
+      return *this;
+    }
+
+    bool operator==(const iterator& Other) const {
+      return Pos == Other.Pos;
+    }
+    bool operator!=(const iterator& Other) const {
+      return Pos != Other.Pos;
+    }
+
+   private:
+    const SmallSiteSet* Set;
+    // Index in Inline, or bit in Bits once spilled; -1 past the end
+    int Pos;
+  };
+
+  iterator begin() const {
+    if (isSpilled())
+      return iterator(this, Bits.find_first());
+    return iterator(this, Size ? 0 : -1);
+  }
+  iterator end() const {
+    return iterator(this, -1);
+  }
+
+  bool empty() const {
+    return Size == 0;
+  }
+  size_t size() const {
+    return Size;
+  }
+
+  // Whether the set holds the null pointer
+  bool hasNull() const {
+    return Size && (isSpilled() ? Bits.test(NullSite) : Inline[0] == NullSite);
+  }
+  // Number of sites other than the null pointer
+  size_t nonNullSize() const {
+    return Size - hasNull();
+  }
+
+  bool contains(SiteID Site) const {
+    if (isSpilled())
+      return Site < Bits.size() && Bits.test(Site);
+    for (unsigned i = 0; i < Size && Inline[i] <= Site; ++i) {
+      if (Inline[i] == Site)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+     * @brief Add Site to the set.
+     *
+     * @return bool Whether the set changed
+     */
+  bool insert(SiteID Site);
+
+  /**
+     * @brief Add the sites of Other to the set.
+     *
+     * @return bool Whether the set changed
+     */
+  bool unionWith(const SmallSiteSet& Other);
+
+  /**
+     * @brief Whether the two sets share a site, without building their
+     * intersection
+     */
+  bool intersects(const SmallSiteSet& Other) const;
+
+  bool operator==(const SmallSiteSet& Other) const;
+  bool operator!=(const SmallSiteSet& Other) const {
+    return !(*this == Other);
+  }
+
+ private:
+  unsigned Size = 0;
+  // The sites in increasing order while not spilled
+  SiteID Inline[InlineCapacity] = {};
+  // The sites once spilled, empty before
+  llvm::BitVector Bits;
+
+  bool isSpilled() const {
+    return Size > InlineCapacity;
+  }
+
+  /**
+     * @brief Move the inline sites to Bits, sized for sites up to MaxSite
+     */
+  void spill(SiteID MaxSite);
+};
+
+}  // namespace dataflow
+
+#endif  // SMALL_SITE_SET_H
@@ -0,0 +1,85 @@
+#ifndef STEENSGAARD_POINTER_ANALYSIS_H
+#define STEENSGAARD_POINTER_ANALYSIS_H
+
+#include "PointsToBackend.h"
+#include "llvm/IR/Function.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Steensgaard Pointer Analysis
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Unification-based points-to analysis.
+ *
+ * Every variable and allocation site is a node in a union-find forest and
+ * each equivalence class has at most one pointee class. Assignments unify
+ * pointee classes instead of propagating sets, so the whole function is
+ * solved in a single pass over its instructions in near-linear time. The
+ * result over-approximates DoubleFreePointerAnalysis: whenever the latter
+ * reports an alias, so does this one.
+ */
+class SteensgaardPointerAnalysis : public PointsToBackend {
+ public:
+  /**
+     * @brief Build the points-to equivalence classes
+     *
+     * @param F The function for which pointer analysis is done
+     */
+  SteensgaardPointerAnalysis(Function& F);
+
+  /**
+     * @brief Unify the classes constrained by an allocation, store, load or
+     * pointer copy.
+     *
+     * @param Inst The instruction to be analyzed for aliasing
+     */
+  void transfer(Instruction* Inst);
+
+  bool alias(std::string& Ptr1, std::string& Ptr2) const override;
+
+  std::vector<std::string> aliases(const std::string& Ptr) const override;
+
+  /**
+     * @brief Returns true if the argument of some `free` in F may alias another
+     * pointer of F. When this is false, the transfer functions never find an
+     * alias to propagate a free to, so the precise solver is not needed.
+     *
+     * @param F The function this analysis was built for
+     * @return bool
+     */
+  bool freesMayAlias(Function& F) const;
+
+ private:
+  // Node of every variable name and allocation site
+  std::map<std::string, unsigned> Nodes;
+  // Union-find forest, indexed by node
+  mutable std::vector<unsigned> Parent;
+  std::vector<unsigned> Rank;
+  // Pointee class of each representative, or NoPointee
+  std::vector<unsigned> Pointee;
+  // Whether the class of a representative contains an allocation site
+  std::vector<bool> HasSite;
+  // Pointer variables of the function grouped by the representative of their
+  // pointee class, filled once solving is done. Entries point to the keys of
+  // Nodes.
+  std::map<unsigned, std::vector<const std::string*>> PointedBy;
+
+  static constexpr unsigned NoPointee = ~0u;
+
+  unsigned node(const std::string& Name);
+  unsigned site(const std::string& Name);
+  unsigned find(unsigned N) const;
+  unsigned pointee(unsigned N);
+  void join(unsigned A, unsigned B);
+};
+}  // namespace dataflow
+
+#endif  // STEENSGAARD_POINTER_ANALYSIS_H
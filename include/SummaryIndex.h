@@ -0,0 +1,133 @@
+#ifndef SUMMARY_INDEX_H
+#define SUMMARY_INDEX_H
+
+#include "FunctionSummary.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace llvm;
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Cross-Module Summary Index
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Parameter Param of a function, or a fresh allocation of it when Param
+ * is the number of parameters, may be passed as argument Arg of a direct call
+ * to Callee.
+ */
+struct SummaryEdge {
+  unsigned Param;
+  std::string Callee;
+  unsigned Arg;
+
+  bool operator<(const SummaryEdge& Other) const {
+    return std::tie(Param, Callee, Arg) < std::tie(Other.Param, Other.Callee, Other.Arg);
+  }
+};
+
+/**
+ * @brief Function summaries of several modules, by function name.
+ *
+ * Each module writes the summaries of its defined functions, computed with
+ * the functions it only declares treated as no-ops, together with the edges
+ * from their parameters to the arguments of the calls they make. Functions
+ * with local linkage are named after their module, so that they do not clash
+ * with those of other modules. Linking merges the files of several modules
+ * and propagates the frees, dereferences and escapes of each function to its
+ * callers along the edges, across module boundaries, until nothing changes.
+ * Each module is then analyzed again with the linked summaries of the
+ * functions it declares, which needs no other module in memory, so the
+ * modules can be checked in parallel.
+ *
+ * ReturnsFresh is not propagated: a function returning what a function of
+ * another module returns keeps the summary of its own module, where that call
+ * is not known to be fresh. A function passing fresh memory to a function of
+ * another module that frees it loses ReturnsFresh.
+ *
+ * The file is a sequence of little-endian 32-bit words: a magic number, the
+ * format version, the AnalysisCache version, the name table, each name as
+ * its length in bytes and the bytes padded to a whole word, then the number
+ * of functions and, for each, the index of its name, its serialized summary,
+ * the number of its edges and each edge as a parameter, the index of the
+ * callee name and an argument.
+ */
+class SummaryIndex {
+ public:
+  /**
+   * @brief Add the function Name, replacing any earlier one.
+   */
+  void add(StringRef Name, FunctionSummary Summary, std::vector<SummaryEdge> Edges);
+
+  /**
+   * @brief Summary of the function Name, or null if it is not in the index.
+   */
+  const FunctionSummary* lookup(StringRef Name) const;
+
+  size_t size() const {
+    return Functions.size();
+  }
+
+  /**
+   * @brief Add the functions of Other. A function defined by both keeps the
+   * summary it has here.
+   *
+   * @return unsigned Number of functions of Other already in the index
+   */
+  unsigned merge(const SummaryIndex& Other);
+
+  /**
+   * @brief Add to the facts of each function those of the functions it calls
+   * along its edges, until no fact changes.
+   *
+   * @return unsigned Number of rounds over the edges
+   */
+  unsigned propagate();
+
+  /**
+   * @brief Write the index to Path.
+   *
+   * @return bool False, with Error set, if the file could not be written
+   */
+  bool write(StringRef Path, std::string& Error) const;
+
+  /**
+   * @brief Add the functions of the index file at Path.
+   *
+   * @return bool False, with Error set, if the file could not be read or is
+   * not an index of this version
+   */
+  bool read(StringRef Path, std::string& Error);
+
+ private:
+  struct Entry {
+    FunctionSummary Summary;
+    std::vector<SummaryEdge> Edges;
+  };
+
+  // Ordered, so that the same summaries are written the same way
+  std::map<std::string, Entry, std::less<>> Functions;
+};
+
+/**
+ * @brief Name of F in a summary index: its own name, prefixed by the
+ * identifier of its module if it has local linkage.
+ */
+std::string indexName(const Function& F);
+
+/**
+ * @brief Import into Summaries the summaries of the index file at Path for
+ * the functions its module declares, and abort if the file cannot be read.
+ */
+void importSummaryIndex(FunctionSummaries& Summaries, StringRef Path);
+
+}  // namespace dataflow
+
+#endif  // SUMMARY_INDEX_H
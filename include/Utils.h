@@ -25,6 +25,16 @@ std::string variable(const Value* Val);
  */
 std::string address(const Value* Val);
 
+/**
+ * @brief Strip casts and address arithmetic off a constant pointer. The
+ * module and flow-sensitive solvers name objects, not fields, so a GEP
+ * points wherever its base does.
+ *
+ * @param V The pointer to strip
+ * @return const Value* The global or constant V is based on
+ */
+const Value* stripConstant(const Value* V);
+
 /**
  * @brief Get the Domain of Val from Memory Or try Extracting it.
  *
@@ -34,6 +44,16 @@ std::string address(const Value* Val);
  */
 Domain* getOrExtract(const Memory* Mem, const Value* Val);
 
+/**
+ * @brief Get the Domain of the variable Name from Memory, or Uninit if it has
+ * none yet.
+ *
+ * @param Mem Memory containing the domain of Name.
+ * @param Name Name of the variable, as given by variable().
+ * @return Domain* Domain of Name in Mem
+ */
+Domain* getOrExtract(const Memory* Mem, const std::string& Name);
+
 /**
  * @brief Print the Memorm Mem in a human readable format to stderr.
  *
@@ -76,6 +96,36 @@ void printMap(Function& F,
     std::map<Instruction*, Memory*>& InMap,
     std::map<Instruction*, Memory*>& OutMap);
 
+/**
+ * @brief Add to Calls the direct calls of F to defined functions, with the
+ * states of their pointer arguments in the In memory of the call. Other
+ * arguments are Uninit.
+ *
+ * @param F Function whose calls to collect.
+ * @param InMap Map of In memory of every instruction in function F.
+ * @param Calls The calls of F, to be analyzed in their context.
+ */
+void addContextCalls(Function& F,
+    std::map<Instruction*, Memory*>& InMap,
+    std::vector<ContextCall>& Calls);
+
+/**
+ * @brief Print the states of the arguments of F in a context, then the In
+ * and Out memory of its instructions as printMap() does, to stderr.
+ *
+ * Format:
+ *   Context of <function>: (<state1>, <state2>, ...)
+ *
+ * @param F Function analyzed in the context.
+ * @param Input States of the arguments of F on entry.
+ * @param InMap Map of In memory of every instruction in function F.
+ * @param OutMap Map of Out memory of every instruction in function F.
+ */
+void printContextMap(Function& F,
+    const ContextInput& Input,
+    std::map<Instruction*, Memory*>& InMap,
+    std::map<Instruction*, Memory*>& OutMap);
+
 }  // namespace dataflow
 
 #endif  // UTILS_H
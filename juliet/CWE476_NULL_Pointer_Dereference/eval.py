@@ -9,7 +9,7 @@ OUT_GLOBS = [
     "s*/CWE476_NULL_Pointer_Dereference__*.out",
     "CWE476_NULL_Pointer_Dereference__*.out",
 ]
-RUN_FN_RE = re.compile(r"^Running NullPointerAnalysis on (\S+)")
+RUN_FN_RE = re.compile(r"^Running (?:PointerAnalysis|NullPointerAnalysis|NullDataflow) on (\S+)")
 # Match warnings with function name: "Possible null dereference ... in FUNC_NAME at:"
 PA_WARN_FN_RE = re.compile(r"Possible null dereference.*? in (\S+) at:")
 
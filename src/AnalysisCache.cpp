@@ -0,0 +1,211 @@
+#include "AnalysisCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <chrono>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Persistent Analysis Cache Implementation
+//===----------------------------------------------------------------------===//
+
+// "CWEA", and the version of the entry layout below
+static constexpr uint32_t EntryMagic = 0x41455743;
+static constexpr uint32_t EntryFormat = 1;
+static constexpr size_t HeaderWords = 4;
+
+AnalysisCache::AnalysisCache(StringRef Dir) : Dir(Dir.str()) {
+  // A directory that cannot be created makes every lookup a miss
+  sys::fs::create_directories(Dir);
+}
+
+std::string AnalysisCache::path(const MD5::MD5Result& Key) const {
+  return Dir + "/" + Key.digest().str().str();
+}
+
+bool AnalysisCache::lookup(const MD5::MD5Result& Key, std::vector<uint32_t>& Payload) {
+  using Clock = std::chrono::steady_clock;
+  auto Start = Clock::now();
+
+  // Mapped rather than read when the file is large enough
+  auto Buffer = MemoryBuffer::getFile(path(Key), /*IsText=*/false,
+      /*RequiresNullTerminator=*/false);
+  if (!Buffer) {
+    Misses++;
+    return false;
+  }
+
+  StringRef Data = (*Buffer)->getBuffer();
+  auto Word = [&](size_t i) {
+    return support::endian::read32le(Data.data() + 4 * i);
+  };
+  size_t NumWords = Data.size() / 4;
+  if (Data.size() % 4 || NumWords < HeaderWords || Word(0) != EntryMagic ||
+      Word(1) != EntryFormat || Word(3) != NumWords - HeaderWords) {
+    Misses++;
+    return false;
+  }
+
+  Payload.resize(NumWords - HeaderWords);
+  for (size_t i = 0; i < Payload.size(); ++i)
+    Payload[i] = Word(HeaderWords + i);
+
+  auto Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - Start);
+  SavedMicros += int64_t(Word(2)) - Elapsed.count();
+  Hits++;
+  return true;
+}
+
+void AnalysisCache::store(const MD5::MD5Result& Key, ArrayRef<uint32_t> Payload, double Ms) {
+  int FD;
+  SmallString<128> TempPath;
+  if (sys::fs::createUniqueFile(Dir + "/tmp-%%%%%%%%", FD, TempPath))
+    return;
+
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    support::endian::Writer Writer(OS, support::little);
+    Writer.write<uint32_t>(EntryMagic);
+    Writer.write<uint32_t>(EntryFormat);
+    Writer.write<uint32_t>(uint32_t(std::min(Ms * 1000, double(UINT32_MAX))));
+    Writer.write<uint32_t>(Payload.size());
+    for (uint32_t W : Payload)
+      Writer.write<uint32_t>(W);
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return;
+    }
+  }
+
+  // Atomic, so a concurrent lookup sees the old entry or the new one
+  if (sys::fs::rename(TempPath, path(Key)))
+    sys::fs::remove(TempPath);
+}
+
+void AnalysisCache::print(raw_ostream& O, StringRef What) const {
+  unsigned Total = Hits + Misses;
+  O << What << " cache: " << Hits << " hits, " << Misses << " misses ("
+    << format("%.1f", Total ? 100.0 * Hits / Total : 0.0) << "%), "
+    << format("%.1f", std::max<int64_t>(SavedMicros, 0) / 1000.0) << " ms saved\n";
+}
+
+void hashFunction(const Function& F, MD5& Hash) {
+  // Local values by position, so that their names do not matter
+  DenseMap<const Value*, unsigned> Numbers;
+  unsigned Next = 0;
+  for (auto& Arg : F.args())
+    Numbers[&Arg] = Next++;
+  for (auto& BB : F) {
+    Numbers[&BB] = Next++;
+    for (auto& I : BB)
+      Numbers[&I] = Next++;
+  }
+
+  std::string Buffer;
+  raw_string_ostream OS(Buffer);
+  ModuleSlotTracker MST(F.getParent(), /*ShouldInitializeAllMetadata=*/false);
+  auto Operand = [&](const Value* V) {
+    auto It = Numbers.find(V);
+    if (It != Numbers.end())
+      OS << " %" << It->second;
+    else if (isa<MetadataAsValue>(V))
+      OS << " md";
+    else {
+      OS << ' ';
+      V->printAsOperand(OS, /*PrintType=*/true, MST);
+    }
+  };
+
+  F.getFunctionType()->print(OS);
+  OS << '\n';
+  for (auto& BB : F) {
+    OS << "bb\n";
+    for (auto& I : BB) {
+      OS << I.getOpcodeName() << ' ';
+      I.getType()->print(OS);
+      for (const Value* Op : I.operands())
+        Operand(Op);
+
+      // What the operands do not tell apart
+      if (auto* Cmp = dyn_cast<CmpInst>(&I)) {
+        OS << ' ' << CmpInst::getPredicateName(Cmp->getPredicate());
+      } else if (auto* Alloca = dyn_cast<AllocaInst>(&I)) {
+        OS << ' ';
+        Alloca->getAllocatedType()->print(OS);
+      } else if (auto* GEP = dyn_cast<GetElementPtrInst>(&I)) {
+        OS << ' ';
+        GEP->getSourceElementType()->print(OS);
+      } else if (auto* Call = dyn_cast<CallBase>(&I)) {
+        OS << ' ';
+        Call->getFunctionType()->print(OS);
+      } else if (auto* Phi = dyn_cast<PHINode>(&I)) {
+        for (const BasicBlock* Incoming : Phi->blocks())
+          Operand(Incoming);
+      }
+      OS << '\n';
+    }
+  }
+  Hash.update(OS.str());
+}
+
+MD5::MD5Result resultKey(const Function& F,
+    StringRef Analysis,
+    const PointsToOptions& Options,
+    const FunctionSummaries& Summaries) {
+  MD5 Hash;
+  // Threads, Verify, Reduce, Edits and Stats leave the answers unchanged
+  Hash.update(("result " + Twine(AnalysisCache::AnalysisVersion) + " " + Analysis + " " +
+               Twine(unsigned(Options.Mode)) + " " + Twine(Options.MaxFields) + "\n")
+                  .str());
+  // The field offsets of the solvers and the answers of BasicAA follow the
+  // sizes and alignments of the target
+  const Module& M = *F.getParent();
+  Hash.update(M.getDataLayoutStr() + "\n" + M.getTargetTriple() + "\n");
+  hashFunction(F, Hash);
+
+  std::vector<uint32_t> Words;
+  for (const Instruction& I : instructions(F)) {
+    auto* Call = dyn_cast<CallBase>(&I);
+    if (const FunctionSummary* S = Call ? Summaries.lookup(Call->getCalledFunction()) : nullptr)
+      S->serialize(Words);
+  }
+  Hash.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(Words.data()), 4 * Words.size()));
+
+  MD5::MD5Result Key;
+  Hash.final(Key);
+  return Key;
+}
+
+std::vector<uint32_t> instructionPositions(Function& F, const SetVector<Instruction*>& Insts) {
+  std::vector<uint32_t> Positions;
+  uint32_t Position = 0;
+  for (Instruction& I : instructions(F)) {
+    if (Insts.count(&I))
+      Positions.push_back(Position);
+    Position++;
+  }
+  return Positions;
+}
+
+bool instructionsAt(Function& F, ArrayRef<uint32_t> Positions, SetVector<Instruction*>& Insts) {
+  std::vector<Instruction*> All;
+  for (Instruction& I : instructions(F))
+    All.push_back(&I);
+  for (uint32_t Position : Positions) {
+    if (Position >= All.size())
+      return false;
+    Insts.insert(All[Position]);
+  }
+  return true;
+}
+
+}  // namespace dataflow
@@ -0,0 +1,24 @@
+#include "FunctionSummary.h"
+#include "ModulePointerAnalysis.h"
+#include "PointsToBackend.h"
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Analysis Keys
+//===----------------------------------------------------------------------===//
+
+// The analysis manager tells analyses apart by the address of their key.
+// DoubleFreePass.so and UseAfterFreePass.so are built separately and each
+// hold a copy of this file, so the two plugins of one pipeline only share
+// the results of these analyses when the dynamic loader binds both copies of
+// a key to one symbol. opt loads plugins with RTLD_GLOBAL and the keys have
+// default visibility, so the plugin loaded second uses the keys of the first
+// and finds the analyses it registered. Keep the keys out of any version
+// script or -fvisibility=hidden, and link neither plugin with -Bsymbolic, or
+// each plugin computes its own results.
+AnalysisKey PointsToAnalysis::Key;
+AnalysisKey ModulePointsToAnalysis::Key;
+AnalysisKey FunctionSummaryAnalysis::Key;
+
+}  // namespace dataflow
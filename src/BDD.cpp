@@ -0,0 +1,259 @@
+#include "BDD.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace dataflow {
+
+// Terminals sort below every variable
+static constexpr unsigned TerminalVar = UINT_MAX;
+// Marks the end of a unique table bucket; no real node can be referenced from
+// a bucket as node 0, since terminals are never hashed.
+static constexpr BDD EndOfBucket = 0;
+
+static constexpr size_t InitialBuckets = 1 << 16;
+static constexpr size_t CacheSize = 1 << 18;
+
+BDDManager::BDDManager() : Buckets(InitialBuckets, EndOfBucket), Cache(CacheSize) {
+  Nodes.push_back({TerminalVar, False, False, EndOfBucket});
+  Nodes.push_back({TerminalVar, True, True, EndOfBucket});
+}
+
+uint64_t BDDManager::hash(unsigned A, unsigned B, unsigned C) {
+  uint64_t H = A;
+  H = H * 0x9E3779B97F4A7C15ull + B;
+  H = H * 0x9E3779B97F4A7C15ull + C;
+  return H ^ (H >> 29);
+}
+
+bool BDDManager::lookup(unsigned Op, unsigned A, unsigned B, unsigned C, BDD& Result) const {
+  const CacheEntry& E = Cache[hash(A ^ (Op << 28), B, C) & (Cache.size() - 1)];
+  if (E.Op != Op || E.A != A || E.B != B || E.C != C)
+    return false;
+  Result = E.Result;
+  return true;
+}
+
+void BDDManager::insert(unsigned Op, unsigned A, unsigned B, unsigned C, BDD Result) {
+  Cache[hash(A ^ (Op << 28), B, C) & (Cache.size() - 1)] = {Op, A, B, C, Result};
+}
+
+void BDDManager::rehash() {
+  std::vector<BDD> NewBuckets(Buckets.size() * 2, EndOfBucket);
+  for (BDD N = 2; N < Nodes.size(); ++N) {
+    Node& Nd = Nodes[N];
+    size_t B = hash(Nd.Var, Nd.Low, Nd.High) & (NewBuckets.size() - 1);
+    Nd.Next = NewBuckets[B];
+    NewBuckets[B] = N;
+  }
+  Buckets.swap(NewBuckets);
+}
+
+BDD BDDManager::mk(unsigned Var, BDD Low, BDD High) {
+  if (Low == High)
+    return Low;
+
+  size_t B = hash(Var, Low, High) & (Buckets.size() - 1);
+  for (BDD N = Buckets[B]; N != EndOfBucket; N = Nodes[N].Next) {
+    const Node& Nd = Nodes[N];
+    if (Nd.Var == Var && Nd.Low == Low && Nd.High == High)
+      return N;
+  }
+
+  BDD N = Nodes.size();
+  Nodes.push_back({Var, Low, High, Buckets[B]});
+  Buckets[B] = N;
+  if (Nodes.size() > 2 * Buckets.size())
+    rehash();
+  return N;
+}
+
+unsigned BDDManager::topVar(BDD F) const {
+  return Nodes[F].Var;
+}
+
+BDD BDDManager::low(BDD F, unsigned Var) const {
+  return Nodes[F].Var == Var ? Nodes[F].Low : F;
+}
+
+BDD BDDManager::high(BDD F, unsigned Var) const {
+  return Nodes[F].Var == Var ? Nodes[F].High : F;
+}
+
+BDD BDDManager::var(unsigned Var) {
+  return mk(Var, False, True);
+}
+
+BDD BDDManager::nvar(unsigned Var) {
+  return mk(Var, True, False);
+}
+
+BDD BDDManager::ite(BDD F, BDD G, BDD H) {
+  if (F == True)
+    return G;
+  if (F == False)
+    return H;
+  if (G == H)
+    return G;
+  if (G == True && H == False)
+    return F;
+
+  BDD Result;
+  if (lookup(IteOp, F, G, H, Result))
+    return Result;
+
+  unsigned V = std::min({topVar(F), topVar(G), topVar(H)});
+  BDD L = ite(low(F, V), low(G, V), low(H, V));
+  BDD R = ite(high(F, V), high(G, V), high(H, V));
+  Result = mk(V, L, R);
+  insert(IteOp, F, G, H, Result);
+  return Result;
+}
+
+BDD BDDManager::bddAnd(BDD F, BDD G) {
+  return ite(F, G, False);
+}
+
+BDD BDDManager::bddOr(BDD F, BDD G) {
+  return ite(F, True, G);
+}
+
+BDD BDDManager::bddNot(BDD F) {
+  return ite(F, False, True);
+}
+
+BDD BDDManager::cube(const std::vector<unsigned>& Vars) {
+  std::vector<unsigned> Sorted = Vars;
+  std::sort(Sorted.begin(), Sorted.end());
+  BDD Result = True;
+  for (auto It = Sorted.rbegin(); It != Sorted.rend(); ++It)
+    Result = mk(*It, False, Result);
+  return Result;
+}
+
+BDD BDDManager::exists(BDD F, BDD Cube) {
+  if (F == True || F == False || Cube == True)
+    return F;
+
+  unsigned V = topVar(F);
+  while (Cube != True && topVar(Cube) < V)
+    Cube = Nodes[Cube].High;
+  if (Cube == True)
+    return F;
+
+  BDD Result;
+  if (lookup(ExistsOp, F, Cube, 0, Result))
+    return Result;
+
+  if (topVar(Cube) == V) {
+    BDD Next = Nodes[Cube].High;
+    Result = bddOr(exists(Nodes[F].Low, Next), exists(Nodes[F].High, Next));
+  } else {
+    Result = mk(V, exists(Nodes[F].Low, Cube), exists(Nodes[F].High, Cube));
+  }
+  insert(ExistsOp, F, Cube, 0, Result);
+  return Result;
+}
+
+BDD BDDManager::relProd(BDD F, BDD G, BDD Cube) {
+  if (F == False || G == False)
+    return False;
+  if (F == True && G == True)
+    return True;
+  if (F == True)
+    return exists(G, Cube);
+  if (G == True)
+    return exists(F, Cube);
+
+  unsigned V = std::min(topVar(F), topVar(G));
+  while (Cube != True && topVar(Cube) < V)
+    Cube = Nodes[Cube].High;
+  if (Cube == True)
+    return bddAnd(F, G);
+
+  if (F > G)
+    std::swap(F, G);
+  BDD Result;
+  if (lookup(RelProdOp, F, G, Cube, Result))
+    return Result;
+
+  if (topVar(Cube) == V) {
+    BDD Next = Nodes[Cube].High;
+    BDD L = relProd(low(F, V), low(G, V), Next);
+    if (L == True) {
+      Result = True;
+    } else {
+      Result = bddOr(L, relProd(high(F, V), high(G, V), Next));
+    }
+  } else {
+    BDD L = relProd(low(F, V), low(G, V), Cube);
+    BDD R = relProd(high(F, V), high(G, V), Cube);
+    Result = mk(V, L, R);
+  }
+  insert(RelProdOp, F, G, Cube, Result);
+  return Result;
+}
+
+BDD BDDManager::replace(BDD F, const std::vector<unsigned>& Map) {
+  std::unordered_map<BDD, BDD> Memo;
+  return replaceRec(F, Map, Memo);
+}
+
+BDD BDDManager::replaceRec(
+    BDD F, const std::vector<unsigned>& Map, std::unordered_map<BDD, BDD>& Memo) {
+  if (F == True || F == False)
+    return F;
+
+  auto It = Memo.find(F);
+  if (It != Memo.end())
+    return It->second;
+
+  unsigned V = topVar(F);
+  unsigned NewV = V < Map.size() ? Map[V] : V;
+  BDD L = replaceRec(Nodes[F].Low, Map, Memo);
+  BDD R = replaceRec(Nodes[F].High, Map, Memo);
+  // If the renamed variable may no longer be on top of its children, rebuild
+  // the node with ite rather than mk.
+  BDD Result;
+  if (NewV < topVar(L) && NewV < topVar(R)) {
+    Result = mk(NewV, L, R);
+  } else {
+    Result = ite(var(NewV), R, L);
+  }
+  Memo.emplace(F, Result);
+  return Result;
+}
+
+std::vector<uint64_t> BDDManager::values(BDD F, const std::vector<unsigned>& Vars) const {
+  std::vector<uint64_t> Result;
+  valuesRec(F, Vars, 0, 0, Result);
+  return Result;
+}
+
+void BDDManager::valuesRec(BDD F,
+    const std::vector<unsigned>& Vars,
+    size_t I,
+    uint64_t Prefix,
+    std::vector<uint64_t>& Result) const {
+  if (F == False)
+    return;
+  if (I == Vars.size()) {
+    Result.push_back(Prefix);
+    return;
+  }
+
+  // A variable skipped by F takes both values
+  valuesRec(low(F, Vars[I]), Vars, I + 1, Prefix << 1, Result);
+  valuesRec(high(F, Vars[I]), Vars, I + 1, (Prefix << 1) | 1, Result);
+}
+
+size_t BDDManager::numNodes() const {
+  return Nodes.size();
+}
+
+size_t BDDManager::memoryUsage() const {
+  return Nodes.capacity() * sizeof(Node) + Buckets.capacity() * sizeof(BDD) +
+      Cache.capacity() * sizeof(CacheEntry);
+}
+
+}  // namespace dataflow
@@ -0,0 +1,226 @@
+#include "BDDPointerAnalysis.h"
+
+#include "Utils.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+
+namespace dataflow {
+
+unsigned BDDPointerAnalysis::id(const std::string& Name) {
+  auto It = IDs.find(Name);
+  if (It != IDs.end())
+    return It->second;
+
+  unsigned ID = IDs.size();
+  IDs[Name] = ID;
+  return ID;
+}
+
+unsigned BDDPointerAnalysis::bddVar(unsigned D, unsigned Bit) const {
+  return D * Bits + Bit;
+}
+
+BDD BDDPointerAnalysis::encode(unsigned D, unsigned Value) const {
+  BDD Result = BDDManager::True;
+  for (unsigned Bit = 0; Bit < Bits; ++Bit) {
+    bool Set = (Value >> (Bits - 1 - Bit)) & 1;
+    BDD Literal = Set ? Manager.var(bddVar(D, Bit)) : Manager.nvar(bddVar(D, Bit));
+    Result = Manager.bddAnd(Result, Literal);
+  }
+  return Result;
+}
+
+BDD BDDPointerAnalysis::relation(
+    const std::vector<std::pair<unsigned, unsigned>>& Pairs, unsigned D1, unsigned D2) {
+  BDD Result = BDDManager::False;
+  for (auto& [A, B] : Pairs) {
+    Result = Manager.bddOr(Result, Manager.bddAnd(encode(D1, A), encode(D2, B)));
+  }
+  return Result;
+}
+
+BDD BDDPointerAnalysis::domainCube(unsigned D) const {
+  std::vector<unsigned> Vars;
+  for (unsigned Bit = 0; Bit < Bits; ++Bit)
+    Vars.push_back(bddVar(D, Bit));
+  return Manager.cube(Vars);
+}
+
+std::vector<unsigned> BDDPointerAnalysis::renaming(
+    std::initializer_list<std::pair<unsigned, unsigned>> Domains) const {
+  std::vector<unsigned> Map(Bits * NumDomains);
+  for (unsigned V = 0; V < Map.size(); ++V)
+    Map[V] = V;
+  for (auto& [From, To] : Domains) {
+    for (unsigned Bit = 0; Bit < Bits; ++Bit)
+      Map[bddVar(From, Bit)] = bddVar(To, Bit);
+  }
+  return Map;
+}
+
+void BDDPointerAnalysis::transfer(Instruction* Inst) {
+  if (AllocaInst* Alloca = dyn_cast<AllocaInst>(Inst)) {
+    AddressOf.push_back({id(variable(Alloca)), id(address(Alloca))});
+
+  } else if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
+    if (!Store->getValueOperand()->getType()->isPointerTy())
+      return;
+
+    Stores.push_back(
+        {id(variable(Store->getPointerOperand())), id(variable(Store->getValueOperand()))});
+
+  } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
+    if (!Load->getType()->isPointerTy())
+      return;
+
+    Loads.push_back({id(variable(Load)), id(variable(Load->getPointerOperand()))});
+
+  } else if (auto* Call = dyn_cast<CallInst>(Inst)) {
+    if (Call->getType()->isPointerTy()) {
+      AddressOf.push_back({id(variable(Call)), id(address(Call))});
+    }
+
+  } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
+    if (Cast->getType()->isPointerTy() && Cast->getOperand(0)->getType()->isPointerTy()) {
+      Copies.push_back({id(variable(Cast)), id(variable(Cast->getOperand(0)))});
+    }
+
+  } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
+    if (GEP->getType()->isPointerTy()) {
+      Copies.push_back({id(variable(GEP)), id(variable(GEP->getPointerOperand()))});
+    }
+
+  } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
+    if (!Phi->getType()->isPointerTy()) {
+      return;
+    }
+
+    for (unsigned i = 0; i < Phi->getNumIncomingValues(); ++i) {
+      Value* Incoming = Phi->getIncomingValue(i);
+      if (!Incoming->getType()->isPointerTy()) {
+        continue;
+      }
+      Copies.push_back({id(variable(Phi)), id(variable(Incoming))});
+    }
+  }
+}
+
+void BDDPointerAnalysis::solve() {
+  BDD Copy = relation(Copies, Ptr, Src);
+  BDD Load = relation(Loads, Ptr, Src);
+  BDD Store = relation(Stores, Ptr, Src);
+
+  BDD PtrCube = domainCube(Ptr);
+  BDD SrcCube = domainCube(Src);
+  BDD TmpCube = domainCube(Tmp);
+
+  auto PtrToSrc = renaming({{Ptr, Src}});
+  auto PtrToTmp = renaming({{Ptr, Tmp}});
+  auto PtrToSrcSiteToTmp = renaming({{Ptr, Src}, {Site, Tmp}});
+  auto SiteToTmp = renaming({{Site, Tmp}});
+  auto TmpToPtr = renaming({{Tmp, Ptr}});
+
+  // Semi-naive evaluation: every round only joins against the facts that
+  // are new since the previous round (Delta), so no fact is derived twice
+  // from the same premises.
+  BDD Delta = PointsTo;
+  // Load targets (dst, s) with s in the Tmp domain, and store slots (s, q)
+  // with s already renamed to the Ptr domain, derived so far.
+  BDD Targets = BDDManager::False;
+  BDD Slots = BDDManager::False;
+  // Copies of PointsTo with the pointer renamed to Src and to Tmp, grown
+  // by the renamed Delta each round instead of being rebuilt.
+  BDD AllSrc = BDDManager::False;
+  BDD AllTmp = BDDManager::False;
+
+  while (Delta != BDDManager::False) {
+    BDD DeltaSrc = Manager.replace(Delta, PtrToSrc);
+    BDD DeltaTmp = Manager.replace(Delta, PtrToTmp);
+    AllSrc = Manager.bddOr(AllSrc, DeltaSrc);
+    AllTmp = Manager.bddOr(AllTmp, DeltaTmp);
+
+    // dst = src:  pts(dst) |= pts(src)
+    BDD New = Manager.relProd(Copy, DeltaSrc, SrcCube);
+
+    // dst = *p:  pts(dst) |= pts(s) for every s in pts(p)
+    BDD NewTargets =
+        Manager.relProd(Load, Manager.replace(Delta, PtrToSrcSiteToTmp), SrcCube);
+    Targets = Manager.bddOr(Targets, NewTargets);
+    New = Manager.bddOr(New, Manager.relProd(NewTargets, AllTmp, TmpCube));
+    New = Manager.bddOr(New, Manager.relProd(Targets, DeltaTmp, TmpCube));
+
+    // *p = q:  pts(s) |= pts(q) for every s in pts(p)
+    BDD NewSlots = Manager.replace(
+        Manager.relProd(Store, Manager.replace(Delta, SiteToTmp), PtrCube), TmpToPtr);
+    Slots = Manager.bddOr(Slots, NewSlots);
+    New = Manager.bddOr(New, Manager.relProd(NewSlots, AllSrc, SrcCube));
+    New = Manager.bddOr(New, Manager.relProd(Slots, DeltaSrc, SrcCube));
+
+    Delta = Manager.bddAnd(New, Manager.bddNot(PointsTo));
+    PointsTo = Manager.bddOr(PointsTo, Delta);
+  }
+}
+
+BDDPointerAnalysis::BDDPointerAnalysis(Function& F) {
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy()) {
+      AddressOf.push_back({id(variable(&Arg)), id(address(&Arg))});
+    }
+  }
+
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    transfer(&*Iter);
+  }
+
+  while ((1u << Bits) < IDs.size())
+    Bits++;
+
+  PointsTo = relation(AddressOf, Ptr, Site);
+  solve();
+
+  Pointers.assign(IDs.size(), nullptr);
+  for (const std::string& Name : pointerVariables(F)) {
+    auto It = IDs.find(Name);
+    if (It != IDs.end())
+      Pointers[It->second] = &It->first;
+  }
+}
+
+bool BDDPointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
+  auto It1 = IDs.find(Ptr1);
+  auto It2 = IDs.find(Ptr2);
+  if (It1 == IDs.end() || It2 == IDs.end())
+    return false;
+
+  BDD PtrCube = domainCube(Ptr);
+  BDD S1 = Manager.relProd(PointsTo, encode(Ptr, It1->second), PtrCube);
+  BDD S2 = Manager.relProd(PointsTo, encode(Ptr, It2->second), PtrCube);
+  return Manager.bddAnd(S1, S2) != BDDManager::False;
+}
+
+std::vector<std::string> BDDPointerAnalysis::aliases(const std::string& Name) const {
+  auto It = IDs.find(Name);
+  if (It == IDs.end())
+    return {};
+
+  // Sites of Name, then everything pointing to one of them
+  BDD Sites = Manager.relProd(PointsTo, encode(Ptr, It->second), domainCube(Ptr));
+  BDD Aliases = Manager.relProd(PointsTo, Sites, domainCube(Site));
+
+  std::vector<unsigned> PtrVars;
+  for (unsigned Bit = 0; Bit < Bits; ++Bit)
+    PtrVars.push_back(bddVar(Ptr, Bit));
+
+  std::vector<std::string> Result;
+  for (uint64_t ID : Manager.values(Aliases, PtrVars)) {
+    if (ID != It->second && ID < Pointers.size() && Pointers[ID])
+      Result.push_back(*Pointers[ID]);
+  }
+  return Result;
+}
+
+size_t BDDPointerAnalysis::memoryUsage() const {
+  return Manager.memoryUsage();
+}
+
+};  // namespace dataflow
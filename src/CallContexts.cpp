@@ -0,0 +1,144 @@
+#include "CallContexts.h"
+
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <set>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Call-String Contexts Implementation
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Whether every use of F is the callee of a direct call, so that its
+ * callers give all the states it can be entered with.
+ */
+static bool isContextCallee(const Function& F) {
+  if (F.isDeclaration() || F.use_empty())
+    return false;
+  for (const Use& U : F.uses()) {
+    auto* Call = dyn_cast<CallInst>(U.getUser());
+    if (!Call || !Call->isCallee(&U))
+      return false;
+  }
+  return true;
+}
+
+CallContexts::CallContexts(Module& M, unsigned Depth, unsigned Budget, Domain::Element Default)
+    : M(M), Depth(Depth), Budget(Budget), Default(Default) {
+  for (Function& F : M) {
+    if (isContextCallee(F))
+      Callees.insert(&F);
+  }
+}
+
+void CallContexts::run(Solver Solve) {
+  using Clock = std::chrono::steady_clock;
+  auto Start = Clock::now();
+
+  struct Context {
+    Function* F;
+    ContextInput Input;
+    // Calls from a root, Depth for a fallback
+    unsigned Length;
+  };
+  std::deque<Context> Work;
+  std::set<std::pair<const Function*, ContextInput>> Seen;
+  DenseSet<const Function*> Reached;
+  DenseSet<const Function*> FellBack;
+
+  auto Enqueue = [&](Function& F, ContextInput Input, unsigned Length) {
+    if (Seen.count({&F, Input})) {
+      Reused++;
+      return false;
+    }
+    Seen.insert({&F, Input});
+    Reached.insert(&F);
+    Work.push_back({&F, std::move(Input), Length});
+    return true;
+  };
+  auto FallBack = [&](Function& F) {
+    if (FellBack.insert(&F).second && Enqueue(F, ContextInput(F.arg_size(), Default), Depth))
+      Fallbacks++;
+  };
+
+  for (Function& F : M) {
+    if (!F.isDeclaration() && !Callees.count(&F)) {
+      Enqueue(F, ContextInput(F.arg_size(), Default), 0);
+      Roots++;
+    }
+  }
+
+  while (true) {
+    while (!Work.empty()) {
+      Context C = std::move(Work.front());
+      Work.pop_front();
+
+      std::vector<ContextCall> Calls;
+      Solve(*C.F, C.Input, Errors[C.F], Calls);
+
+      for (ContextCall& Call : Calls) {
+        Function& Callee = *Call.first;
+        if (!Callees.count(&Callee))
+          continue;
+        if (C.Length >= Depth) {
+          FallBack(Callee);
+          continue;
+        }
+        // Nothing known about an argument is the same as no context
+        for (Domain::Element& State : Call.second) {
+          if (State == Domain::Uninit)
+            State = Default;
+        }
+        Call.second.resize(Callee.arg_size(), Default);
+        if (Seen.count({&Callee, Call.second})) {
+          Reused++;
+        } else if (Contexts >= Budget) {
+          FallBack(Callee);
+        } else {
+          Enqueue(Callee, std::move(Call.second), C.Length + 1);
+          Contexts++;
+          PerFunction[&Callee]++;
+        }
+      }
+    }
+
+    // Callees only called from functions no root reaches, such as a
+    // recursive cycle of their own, in module order so that the output is
+    // the same on every run
+    bool Unreached = false;
+    for (Function& F : M) {
+      if (Callees.count(&F) && !Reached.count(&F)) {
+        FallBack(F);
+        Unreached = true;
+      }
+    }
+    if (!Unreached)
+      break;
+  }
+
+  Ms = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+const SetVector<Instruction*>& CallContexts::errors(const Function& F) const {
+  static const SetVector<Instruction*> None;
+  auto It = Errors.find(&F);
+  return It == Errors.end() ? None : It->second;
+}
+
+void CallContexts::print(raw_ostream& O, StringRef What) const {
+  unsigned Most = 0;
+  for (auto& I : PerFunction)
+    Most = std::max(Most, I.second);
+  O << What << " contexts: " << Roots << " roots, " << Contexts << " contexts of "
+    << PerFunction.size() << " functions (at most " << Most << "), " << Reused << " reused, "
+    << Fallbacks << " fallbacks, depth " << Depth << ", budget " << Budget << ", "
+    << format("%.1f", Ms) << " ms\n";
+}
+
+}  // namespace dataflow
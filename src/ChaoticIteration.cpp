@@ -255,35 +255,27 @@ void UseAfterFreeAnalysis::flowOut(
   }
 }
 
-void DoubleFreeAnalysis::doAnalysis(Function& F, DoubleFreePointerAnalysis* PA) {
+void DoubleFreeAnalysis::doAnalysis(Function& F, PointsToBackend* PA, const ContextInput* Entry) {
   SetVector<Instruction*> WorkSet;
-  SetVector<Value*> PointerSet;
   /**
    * First, find the arguments of function call and instantiate abstract domain values
    * for each argument.
-   * Initialize the WorkSet and PointerSet with all the instructions in the function.
+   * Initialize the WorkSet with all the instructions in the function.
    * The rest of the implementation is almost similar to the previous lab.
    *
    * While the WorkSet is not empty:
    * - Pop an instruction from the WorkSet.
    * - Construct it's Incoming Memory using flowIn.
    * - Evaluate the instruction using transfer and create the OutMemory.
-   *   Note that the transfer function takes two additional arguments compared to previous lab:
-   *   the DoubleFreePointerAnalysis object and the populated PointerSet.
+   *   Note that the transfer function takes an additional argument compared to previous lab:
+   *   the PointsToBackend object, which enumerates the aliases of a freed pointer.
    * - Use flowOut along with the previous Out memory and the current Out
    *   memory, to check if there is a difference between the two to update the
    *   OutMap and add all successors to WorkSet.
    */
 
-  for (auto& Arg : F.args()) {
-    if (Arg.getType()->isPointerTy()) {
-      PointerSet.insert(&Arg);
-    }
-  }
-
   for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
     WorkSet.insert(&(*I));
-    PointerSet.insert(&(*I));
   }
 
   auto isEntryInst = [&](Instruction* Inst) { return getPredecessors(Inst).empty(); };
@@ -296,46 +288,39 @@ void DoubleFreeAnalysis::doAnalysis(Function& F, DoubleFreePointerAnalysis* PA)
 
     if (isEntryInst(Inst)) {
       for (auto& Arg : F.args()) {
-        (*In)[variable(&Arg)] = new Domain(Domain::MaybeFreed);
+        Domain::Element State = Entry ? (*Entry)[Arg.getArgNo()] : Domain::MaybeFreed;
+        (*In)[variable(&Arg)] = new Domain(State);
       }
     }
 
     Memory OutCur;
-    transfer(Inst, In, OutCur, PA, PointerSet);
+    transfer(Inst, In, OutCur, PA);
 
     flowOut(Inst, In, &OutCur, WorkSet);
   }
 }
 
-void UseAfterFreeAnalysis::doAnalysis(Function& F, DoubleFreePointerAnalysis* PA) {
+void UseAfterFreeAnalysis::doAnalysis(Function& F, PointsToBackend* PA, const ContextInput* Entry) {
   SetVector<Instruction*> WorkSet;
-  SetVector<Value*> PointerSet;
   /**
    * First, find the arguments of function call and instantiate abstract domain values
    * for each argument.
-   * Initialize the WorkSet and PointerSet with all the instructions in the function.
+   * Initialize the WorkSet with all the instructions in the function.
    * The rest of the implementation is almost similar to the previous lab.
    *
    * While the WorkSet is not empty:
    * - Pop an instruction from the WorkSet.
    * - Construct it's Incoming Memory using flowIn.
    * - Evaluate the instruction using transfer and create the OutMemory.
-   *   Note that the transfer function takes two additional arguments compared to previous lab:
-   *   the DoubleFreePointerAnalysis object and the populated PointerSet.
+   *   Note that the transfer function takes an additional argument compared to previous lab:
+   *   the PointsToBackend object, which enumerates the aliases of a freed pointer.
    * - Use flowOut along with the previous Out memory and the current Out
    *   memory, to check if there is a difference between the two to update the
    *   OutMap and add all successors to WorkSet.
    */
 
-  for (auto& Arg : F.args()) {
-    if (Arg.getType()->isPointerTy()) {
-      PointerSet.insert(&Arg);
-    }
-  }
-
   for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
     WorkSet.insert(&(*I));
-    PointerSet.insert(&(*I));
   }
 
   auto isEntryInst = [&](Instruction* Inst) { return getPredecessors(Inst).empty(); };
@@ -348,12 +333,13 @@ void UseAfterFreeAnalysis::doAnalysis(Function& F, DoubleFreePointerAnalysis* PA
 
     if (isEntryInst(Inst)) {
       for (auto& Arg : F.args()) {
-        (*In)[variable(&Arg)] = new Domain(Domain::Live);
+        Domain::Element State = Entry ? (*Entry)[Arg.getArgNo()] : Domain::Live;
+        (*In)[variable(&Arg)] = new Domain(State);
       }
     }
 
     Memory OutCur;
-    transfer(Inst, In, OutCur, PA, PointerSet);
+    transfer(Inst, In, OutCur, PA);
 
     flowOut(Inst, In, &OutCur, WorkSet);
   }
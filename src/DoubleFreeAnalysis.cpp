@@ -1,8 +1,14 @@
 #include "DoubleFreeAnalysis.h"
 
+#include "AnalysisCache.h"
+#include "ModulePointerAnalysis.h"
+#include "SummaryIndex.h"
 #include "Utils.h"
 #include <llvm/Passes/PassPlugin.h>
 
+#include <chrono>
+#include <memory>
+
 namespace dataflow {
 
 //===----------------------------------------------------------------------===//
@@ -12,7 +18,8 @@ namespace dataflow {
 bool DoubleFreeAnalysis::check(Instruction* Inst) {
   /**
    * Inst can cause a double-free if:
-   *   Inst call instruction with name `free`,
+   *   Inst call instruction with name `free`, or to a function whose summary
+   *   frees one of the parameters,
    *   The operand is either Freed or MaybeFreed.
    */
   auto* Call = dyn_cast<CallInst>(Inst);
@@ -25,26 +32,35 @@ bool DoubleFreeAnalysis::check(Instruction* Inst) {
     return false;
   }
 
-  if (!Callee->getName().equals("free")) {
-    return false;
-  }
+  Memory* In = InMap[Inst];
+  auto isFreed = [&](Value* Ptr) {
+    // Track the freed-ness of the pointer value
+    Domain* D = getOrExtract(In, Ptr);
 
-  if (Call->arg_size() < 1) {
-    return false;  // shouldn't be possible, since free takes 1 arg
-  }
+    // If the pointer is definitely NULL, free(NULL) is a no-op -> not an error
+    if (D->Nstate == Domain::Null) {
+      return false;
+    }
 
-  Value* Ptr = Call->getArgOperand(0);
-  Memory* In = InMap[Inst];
+    return D->Value != Domain::Live;
+  };
 
-  // Track the freed-ness of the pointer value
-  Domain* D = getOrExtract(In, Ptr);
+  if (Callee->getName().equals("free")) {
+    // Call->arg_size() < 1 shouldn't be possible, since free takes 1 arg
+    return Call->arg_size() >= 1 && isFreed(Call->getArgOperand(0));
+  }
 
-  // If the pointer is definitely NULL, free(NULL) is a no-op -> not an error
-  if (D->Nstate == Domain::Null) {
+  const FunctionSummary* S = Summaries ? Summaries->lookup(Callee) : nullptr;
+  if (!S) {
     return false;
   }
-
-  return D->Value != Domain::Live;
+  unsigned NumArgs = std::min<unsigned>(Call->arg_size(), S->Frees.size());
+  for (unsigned k = 0; k < NumArgs; ++k) {
+    if (S->Frees.test(k) && isFreed(Call->getArgOperand(k))) {
+      return true;
+    }
+  }
+  return false;
 }
 
 const auto PASS_NAME = "DoubleFree";
@@ -53,6 +69,56 @@ const auto PASS_DESC = "Double-free Analysis";
 PreservedAnalyses DoubleFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM) {
   outs() << "Running " << PASS_DESC << " on module " << M.getName() << "\n";
 
+  // Summaries and warnings of earlier runs, for the functions left unchanged
+  std::unique_ptr<AnalysisCache> SummaryCache, ResultCache;
+  if (!Options.CacheDir.empty()) {
+    SummaryCache = std::make_unique<AnalysisCache>(Options.CacheDir);
+    // The `module` solution of a function depends on the whole module, and
+    // its warnings in context on its callers
+    if (Options.Mode != PointsToMode::Module && Options.ContextDepth == 0)
+      ResultCache = std::make_unique<AnalysisCache>(Options.CacheDir);
+  }
+
+  // Summarized bottom-up once per module, before any function is analyzed
+  FunctionSummaries& ModuleSummaries = AM.getResult<FunctionSummaryAnalysis>(M);
+  // Functions defined in other modules, as summarized when the index was linked
+  if (!Options.IndexFile.empty()) {
+    importSummaryIndex(ModuleSummaries, Options.IndexFile);
+  }
+  ModuleSummaries.compute(Options.Threads, Options.Verify, SummaryCache.get());
+  Summaries = &ModuleSummaries;
+
+  // Each function in the states its callers pass, before any warning is
+  // printed. The facts of each context are printed as it is analyzed.
+  std::unique_ptr<CallContexts> Contexts;
+  if (Options.ContextDepth > 0) {
+    Contexts = std::make_unique<CallContexts>(
+        M, Options.ContextDepth, Options.ContextBudget, Domain::MaybeFreed);
+    Contexts->run([&](Function& F,
+                      const ContextInput& Input,
+                      SetVector<Instruction*>& Errors,
+                      std::vector<ContextCall>& Calls) {
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        InMap[&(*Iter)] = new Memory;
+        OutMap[&(*Iter)] = new Memory;
+      }
+
+      doAnalysis(F, &getPointsToBackend(F, Options, AM), &Input);
+
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        if (check(&(*Iter)))
+          Errors.insert(&(*Iter));
+      }
+      addContextCalls(F, InMap, Calls);
+      printContextMap(F, Input, InMap, OutMap);
+
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        delete InMap[&(*Iter)];
+        delete OutMap[&(*Iter)];
+      }
+    });
+  }
+
   for (auto& F : M) {
     if (F.isDeclaration()) {
       continue;
@@ -62,6 +128,29 @@ PreservedAnalyses DoubleFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM)
 
     ErrorInsts.clear();
 
+    if (Contexts) {
+      ErrorInsts = Contexts->errors(F);
+      printErrorInsts();
+      continue;
+    }
+
+    MD5::MD5Result Key;
+    SetVector<Instruction*> CachedInsts;
+    bool Cached = false;
+    if (ResultCache) {
+      Key = resultKey(F, getAnalysisName(), Options, *Summaries);
+      std::vector<uint32_t> Positions;
+      Cached = ResultCache->lookup(Key, Positions) && instructionsAt(F, Positions, CachedInsts);
+    }
+    // With verify, a cached function is analyzed again and compared. Otherwise
+    // it prints its warnings only, as it has no dataflow facts to dump
+    if (Cached && !Options.Verify) {
+      ErrorInsts = CachedInsts;
+      printErrorInsts();
+      continue;
+    }
+    auto Start = std::chrono::steady_clock::now();
+
     // Initializing InMap and OutMap.
     for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
       auto Inst = &(*Iter);
@@ -70,7 +159,8 @@ PreservedAnalyses DoubleFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM)
     }
 
     // The chaotic iteration algorithm is implemented inside doAnalysis().
-    auto PA = new DoubleFreePointerAnalysis(F);
+    // Shared with any other pass of the pipeline that asked for it
+    PointsToBackend* PA = &getPointsToBackend(F, Options, AM);
     doAnalysis(F, PA);
 
     // Check each instruction in function F for potential divide-by-zero error.
@@ -80,11 +170,21 @@ PreservedAnalyses DoubleFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM)
         ErrorInsts.insert(Inst);
     }
 
+    if (Cached && CachedInsts != ErrorInsts) {
+      report_fatal_error(Twine("cached warnings of ") + F.getName() + " differ from a fresh analysis");
+    }
+    if (ResultCache && !Cached) {
+      ResultCache->store(Key, instructionPositions(F, ErrorInsts),
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start)
+              .count());
+    }
+
     printMap(F, InMap, OutMap);
-    outs() << "Potential Instructions by " << getAnalysisName() << ": \n";
-    for (auto Inst : ErrorInsts) {
-      outs() << *Inst << "\n";
+    if (Options.Stats) {
+      errs() << "Alias cache: " << PA->cacheHits() << " hits, " << PA->cacheMisses()
+             << " misses\n\n";
     }
+    printErrorInsts();
 
     for (auto Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
       delete InMap[&(*Iter)];
@@ -92,18 +192,53 @@ PreservedAnalyses DoubleFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM)
     }
   }
 
+  // The warnings are buffered, the summaries are not
+  outs().flush();
+  if (SummaryCache) {
+    SummaryCache->print(errs(), "Summary");
+  }
+  if (ResultCache) {
+    ResultCache->print(errs(), getAnalysisName());
+  }
+  if (Contexts) {
+    Contexts->print(errs(), getAnalysisName());
+  }
+  printPointsToStatistics();
   return PreservedAnalyses::all();
 }
 
+void DoubleFreeAnalysis::printErrorInsts() {
+  outs() << "Potential Instructions by " << getAnalysisName() << ": \n";
+  for (auto Inst : ErrorInsts) {
+    outs() << *Inst << "\n";
+  }
+}
+
 // Pass registration for the new pass manager
 extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
   return {LLVM_PLUGIN_API_VERSION, PASS_NAME, "1.0.0", [](PassBuilder& PB) {
+            PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager& FAM) {
+              FAM.registerPass([] { return PointsToAnalysis(); });
+            });
+            PB.registerAnalysisRegistrationCallback([](ModuleAnalysisManager& MAM) {
+              MAM.registerPass([] { return ModulePointsToAnalysis(); });
+              MAM.registerPass([] { return FunctionSummaryAnalysis(); });
+            });
             PB.registerPipelineParsingCallback(
                 [](StringRef Name,
                     ModulePassManager& MPM,
                     ArrayRef<PassBuilder::PipelineElement>) {
-                  if (Name == PASS_NAME) {
-                    MPM.addPass(DoubleFreeAnalysis());
+                  PointsToOptions Options;
+                  if (parsePointsToOptions(Name, PASS_NAME, Options)) {
+                    MPM.addPass(DoubleFreeAnalysis(Options));
+                    return true;
+                  }
+                  if (parsePointsToOptions(Name, "PointsTo", Options)) {
+                    MPM.addPass(PointsToBenchmark(Options));
+                    return true;
+                  }
+                  if (parsePointsToOptions(Name, "FunctionSummary", Options)) {
+                    MPM.addPass(FunctionSummaryPrinter(Options));
                     return true;
                   }
                   return false;
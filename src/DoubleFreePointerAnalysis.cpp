@@ -1,15 +1,40 @@
 #include "DoubleFreePointerAnalysis.h"
 
 #include "Utils.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/InstIterator.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+#define DEBUG_TYPE "points-to"
+
+// Always enabled, so that `opt -stats` reports them on release builds of LLVM
+ALWAYS_ENABLED_STATISTIC(NumAllocConstraints, "Allocation constraints");
+ALWAYS_ENABLED_STATISTIC(NumCopyConstraints, "Copy constraints");
+ALWAYS_ENABLED_STATISTIC(NumLoadConstraints, "Load constraints");
+ALWAYS_ENABLED_STATISTIC(NumStoreConstraints, "Store constraints");
+ALWAYS_ENABLED_STATISTIC(NumSolverRounds, "Rounds of the points-to fixpoint");
+ALWAYS_ENABLED_STATISTIC(NumPointsToFacts, "Points-to facts");
+ALWAYS_ENABLED_STATISTIC(NumPointsToSets, "Distinct points-to sets");
+ALWAYS_ENABLED_STATISTIC(NumCollapsedObjects, "Objects collapsed past the field cap");
+ALWAYS_ENABLED_STATISTIC(MaxPointsToSetSize, "Size of the largest points-to set");
 
 namespace dataflow {
 
-void DoubleFreePointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
+// Number of largest sets kept in the statistics
+static constexpr size_t NumLargest = 5;
+
+void DoubleFreePointerAnalysis::transfer(Instruction* Inst, InternedPointsToInfo& PointsTo) {
   if (AllocaInst* Alloca = dyn_cast<AllocaInst>(Inst)) {
-    PointsToSet& S = PointsTo[variable(Alloca)];
-    S.insert(address(Alloca));
+    SetID& S = PointsTo[variable(Alloca)];
+    S = Pool.setUnion(S, Pool.singleton(Pool.site(address(Alloca))));
 
   } else if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
     if (!Store->getValueOperand()->getType()->isPointerTy())
@@ -18,14 +43,12 @@ void DoubleFreePointerAnalysis::transfer(Instruction* Inst, PointsToInfo& Points
     Value* Pointer = Store->getPointerOperand();
     Value* Value = Store->getValueOperand();
 
-    PointsToSet& L = PointsTo[variable(Pointer)];
-    PointsToSet& R = PointsTo[variable(Value)];
-    for (auto& I : L) {
-      PointsToSet& S = PointsTo[I];
-      PointsToSet Result;
-      std::set_union(
-          S.begin(), S.end(), R.begin(), R.end(), std::inserter(Result, Result.begin()));
-      PointsTo[I] = Result;
+    // Copy the sites out: interning new sets may reallocate the pool.
+    std::vector<SiteID> L = Pool.elements(PointsTo[variable(Pointer)]);
+    SetID R = PointsTo[variable(Value)];
+    for (SiteID I : L) {
+      SetID& S = PointsTo[Pool.siteName(canonical(I))];
+      S = Pool.setUnion(S, R);
     }
 
   } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
@@ -34,22 +57,17 @@ void DoubleFreePointerAnalysis::transfer(Instruction* Inst, PointsToInfo& Points
     }
 
     std::string VariableName = variable(Load->getPointerOperand());
-    PointsToSet& R = PointsTo[VariableName];
-    PointsToSet Result;
-    for (auto& I : R) {
-      PointsToSet& S = PointsTo[I];
-      std::set_union(S.begin(),
-          S.end(),
-          Result.begin(),
-          Result.end(),
-          std::inserter(Result, Result.begin()));
+    std::vector<SiteID> R = Pool.elements(PointsTo[VariableName]);
+    SetID Result = PointsToSetPool::Empty;
+    for (SiteID I : R) {
+      Result = Pool.setUnion(Result, PointsTo[Pool.siteName(canonical(I))]);
     }
     PointsTo[variable(Load)] = Result;
 
   } else if (auto* Call = dyn_cast<CallInst>(Inst)) {
     if (Call->getType()->isPointerTy()) {
-      PointsToSet& S = PointsTo[variable(Call)];
-      S.insert(address(Call));
+      SetID& S = PointsTo[variable(Call)];
+      S = Pool.setUnion(S, Pool.singleton(Pool.site(address(Call))));
     }
 
   } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
@@ -58,86 +76,685 @@ void DoubleFreePointerAnalysis::transfer(Instruction* Inst, PointsToInfo& Points
     }
 
   } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
-    if (GEP->getType()->isPointerTy()) {
-      PointsTo[variable(GEP)] = PointsTo[variable(GEP->getPointerOperand())];
+    if (!GEP->getType()->isPointerTy()) {
+      return;
+    }
+
+    SetID Base = PointsTo[variable(GEP->getPointerOperand())];
+    if (MaxFields <= 1) {
+      PointsTo[variable(GEP)] = Base;
+      return;
+    }
+
+    int64_t Offset = fieldOffset(GEP);
+    if (Offset == 0) {
+      PointsTo[variable(GEP)] = Base;
+      return;
     }
 
+    std::vector<SiteID> Sites = Pool.elements(Base);
+    for (SiteID& I : Sites) {
+      I = field(I, Offset);
+    }
+    PointsTo[variable(GEP)] = Pool.fromSites(std::move(Sites));
+
   } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
     if (!Phi->getType()->isPointerTy()) {
       return;
     }
 
-    PointsToSet Result;
+    SetID Result = PointsToSetPool::Empty;
     for (unsigned i = 0; i < Phi->getNumIncomingValues(); ++i) {
       Value* Incoming = Phi->getIncomingValue(i);
       if (!Incoming->getType()->isPointerTy()) {
         continue;
       }
-      PointsToSet& S = PointsTo[variable(Incoming)];
-      std::set_union(S.begin(),
-          S.end(),
-          Result.begin(),
-          Result.end(),
-          std::inserter(Result, Result.begin()));
+      Result = Pool.setUnion(Result, PointsTo[variable(Incoming)]);
     }
     PointsTo[variable(Phi)] = Result;
   }
 }
 
-int DoubleFreePointerAnalysis::countFacts(PointsToInfo& PointsTo) {
+int64_t DoubleFreePointerAnalysis::fieldOffset(GetElementPtrInst* GEP) {
+  // Only struct indices select a field. Array indexing and pointer
+  // arithmetic stay within the same field, so all elements of an array
+  // are one node and a variable index needs no special case.
+  const DataLayout& DL = GEP->getModule()->getDataLayout();
+  int64_t Offset = 0;
+  for (auto GTI = gep_type_begin(GEP), E = gep_type_end(GEP); GTI != E; ++GTI) {
+    if (StructType* Struct = GTI.getStructTypeOrNull()) {
+      unsigned Index = cast<ConstantInt>(GTI.getOperand())->getZExtValue();
+      Offset += DL.getStructLayout(Struct)->getElementOffset(Index);
+    }
+  }
+  return Offset;
+}
+
+SiteID DoubleFreePointerAnalysis::field(SiteID Site, int64_t Offset) {
+  auto It = FieldOf.find(Site);
+  if (It != FieldOf.end()) {
+    Site = It->second.first;
+    Offset += It->second.second;
+  }
+  if (Offset == 0 || Collapsed.count(Site))
+    return Site;
+
+  std::map<int64_t, SiteID>& ObjectFields = Fields[Site];
+  auto Existing = ObjectFields.find(Offset);
+  if (Existing != ObjectFields.end())
+    return Existing->second;
+
+  // Offset 0 counts as a field
+  if (ObjectFields.size() + 1 >= MaxFields)
+    return collapse(Site);
+
+  SiteID Field = Pool.site(Pool.siteName(Site) + "+" + std::to_string(Offset));
+  ObjectFields[Offset] = Field;
+  FieldOf[Field] = {Site, Offset};
+  return Field;
+}
+
+void DoubleFreePointerAnalysis::aliasSites(SiteID Site, std::vector<SiteID>& Sites) const {
+  Sites.push_back(Site);
+  auto Field = FieldOf.find(Site);
+  if (Field != FieldOf.end()) {
+    Sites.push_back(Field->second.first);
+    return;
+  }
+  auto ObjectFields = Fields.find(Site);
+  if (ObjectFields == Fields.end())
+    return;
+  for (auto& F : ObjectFields->second)
+    Sites.push_back(F.second);
+}
+
+SiteID DoubleFreePointerAnalysis::collapse(SiteID Site) {
+  auto It = FieldOf.find(Site);
+  if (It != FieldOf.end())
+    Site = It->second.first;
+  if (Collapsed.insert(Site).second && Fields.count(Site))
+    CollapseChanged = true;
+  return Site;
+}
+
+SiteID DoubleFreePointerAnalysis::canonical(SiteID Site) const {
+  auto It = FieldOf.find(Site);
+  if (It != FieldOf.end() && Collapsed.count(It->second.first))
+    return It->second.first;
+  return Site;
+}
+
+void DoubleFreePointerAnalysis::canonicalize(InternedPointsToInfo& PointsTo) {
+  for (auto& I : PointsTo) {
+    std::vector<SiteID> Sites = Pool.elements(I.second);
+    if (std::none_of(Sites.begin(), Sites.end(), [&](SiteID S) { return canonical(S) != S; }))
+      continue;
+
+    for (SiteID& S : Sites)
+      S = canonical(S);
+    I.second = Pool.fromSites(std::move(Sites));
+  }
+
+  // What was stored into a field before its object collapsed. Stores have
+  // written to the object since, so nothing reads these entries.
+  for (SiteID Object : Collapsed) {
+    auto ObjectFields = Fields.find(Object);
+    if (ObjectFields == Fields.end())
+      continue;
+    for (auto& Field : ObjectFields->second)
+      PointsTo.erase(Pool.siteName(Field.second));
+  }
+}
+
+int DoubleFreePointerAnalysis::countFacts(InternedPointsToInfo& PointsTo) {
   int N = 0;
   for (auto& I : PointsTo)
-    N += I.second.size();
+    N += Pool.size(I.second);
   return N;
 }
 
-void DoubleFreePointerAnalysis::print(std::map<std::string, PointsToSet>& PointsTo) {
+void DoubleFreePointerAnalysis::print(InternedPointsToInfo& PointsTo) {
   errs() << "Pointer Analysis Results:\n";
   for (auto& I : PointsTo) {
     errs() << "  " << I.first << ": { ";
-    for (auto& J : I.second) {
-      errs() << J << "; ";
+    for (SiteID J : Pool.elements(I.second)) {
+      errs() << Pool.siteName(J) << "; ";
     }
     errs() << "}\n";
   }
+  errs() << "  (" << PointsTo.size() << " entries share " << Pool.numSets()
+         << " distinct points-to sets, average size "
+         << format("%.2f", PointsTo.empty() ? 0.0 : double(countFacts(PointsTo)) / PointsTo.size())
+         << ", " << FieldOf.size() << " field sites)\n";
   errs() << "\n";
 }
 
-DoubleFreePointerAnalysis::DoubleFreePointerAnalysis(Function& F) {
+void DoubleFreePointerAnalysis::buildInverseIndex(Function& F) {
+  PointedBy.assign(Pool.numSites(), {});
+  for (const std::string& Name : pointerVariables(F)) {
+    auto It = PointsTo.find(Name);
+    if (It == PointsTo.end())
+      continue;
+    for (SiteID S : Pool.elements(It->second)) {
+      PointedBy[S].push_back(&It->first);
+    }
+  }
+}
+
+unsigned DoubleFreePointerAnalysis::solve(InternedPointsToInfo& PointsTo) {
   int NumOfOldFacts = 0;
   int NumOfNewFacts = 0;
+  unsigned Rounds = 0;
 
-  for (auto& Arg : F.args()) {
+  for (auto& Arg : Func->args()) {
     if (Arg.getType()->isPointerTy()) {
-      PointsToSet& S = PointsTo[variable(&Arg)];
-      S.insert(address(&Arg));
+      SetID& S = PointsTo[variable(&Arg)];
+      S = Pool.setUnion(S, Pool.singleton(Pool.site(address(&Arg))));
     }
   }
 
   while (true) {
-    for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    Rounds++;
+    for (inst_iterator Iter = inst_begin(*Func), E = inst_end(*Func); Iter != E; ++Iter) {
       auto Inst = &*Iter;
-      transfer(Inst, PointsTo);
+      if (!Retracted.count(Inst))
+        transfer(Inst, PointsTo);
     }
     NumOfNewFacts = countFacts(PointsTo);
-    if (NumOfOldFacts < NumOfNewFacts)
+    // A collapse redirects contents and may shrink GEP results, so the facts
+    // found after it are not comparable to the count before it.
+    if (NumOfOldFacts < NumOfNewFacts || CollapseChanged)
       NumOfOldFacts = NumOfNewFacts;
     else
       break;
+    CollapseChanged = false;
+  }
+  canonicalize(PointsTo);
+  return Rounds;
+}
+
+DoubleFreePointerAnalysis::DoubleFreePointerAnalysis(
+    Function& F, unsigned MaxFields, bool JSONStats)
+    : Func(&F), MaxFields(MaxFields) {
+  using Clock = std::chrono::steady_clock;
+  auto Start = Clock::now();
+  Stats.Rounds = solve(PointsTo);
+  auto Solved = Clock::now();
+  buildInverseIndex(F);
+  Stats.SolveMs = std::chrono::duration<double, std::milli>(Solved - Start).count();
+  Stats.IndexMs = std::chrono::duration<double, std::milli>(Clock::now() - Solved).count();
+
+  collectStats();
+  if (JSONStats)
+    printStats(errs());
+  else
+    print(PointsTo);
+}
+
+DoubleFreePointerAnalysis::DoubleFreePointerAnalysis(Function& F,
+    unsigned MaxFields,
+    const std::set<Instruction*>& Retracted,
+    const std::vector<std::string>& Collapsed)
+    : Func(&F), MaxFields(MaxFields), Retracted(Retracted) {
+  for (const std::string& Name : Collapsed)
+    this->Collapsed.insert(Pool.site(Name));
+  solve(PointsTo);
+  buildInverseIndex(F);
+}
+
+void DoubleFreePointerAnalysis::collectStats() {
+  for (auto& Arg : Func->args())
+    Stats.Allocs += Arg.getType()->isPointerTy();
+  for (auto& I : instructions(*Func)) {
+    if (isa<AllocaInst>(I)) {
+      Stats.Allocs++;
+    } else if (auto* Store = dyn_cast<StoreInst>(&I)) {
+      Stats.Stores += Store->getValueOperand()->getType()->isPointerTy();
+    } else if (!I.getType()->isPointerTy()) {
+      continue;
+    } else if (isa<LoadInst>(I)) {
+      Stats.Loads++;
+    } else if (isa<CallInst>(I)) {
+      Stats.Allocs++;
+    } else if (auto* Cast = dyn_cast<CastInst>(&I)) {
+      Stats.Copies += Cast->getOperand(0)->getType()->isPointerTy();
+    } else if (isa<GetElementPtrInst>(I) || isa<PHINode>(I)) {
+      Stats.Copies++;
+    }
+  }
+
+  // Sites are entries too, for what is stored there
+  Stats.Variables = PointsTo.size();
+  Stats.Facts = countFacts(PointsTo);
+  Stats.Sets = Pool.numSets();
+  Stats.FieldSites = FieldOf.size();
+  Stats.Collapsed = Collapsed.size();
+  Stats.PoolBytes = Pool.memoryUsage();
+
+  std::vector<std::pair<std::string, size_t>> Sizes;
+  for (auto& I : PointsTo) {
+    size_t Size = Pool.size(I.second);
+    size_t Bucket = Size == 0 ? 0 : Log2_64(Size) + 1;
+    if (Stats.Histogram.size() <= Bucket)
+      Stats.Histogram.resize(Bucket + 1);
+    Stats.Histogram[Bucket]++;
+    Sizes.push_back({I.first, Size});
+  }
+  auto Larger = [](const auto& A, const auto& B) {
+    return A.second > B.second || (A.second == B.second && A.first < B.first);
+  };
+  size_t N = std::min(NumLargest, Sizes.size());
+  std::partial_sort(Sizes.begin(), Sizes.begin() + N, Sizes.end(), Larger);
+  Stats.Largest.assign(Sizes.begin(), Sizes.begin() + N);
+
+  NumAllocConstraints += Stats.Allocs;
+  NumCopyConstraints += Stats.Copies;
+  NumLoadConstraints += Stats.Loads;
+  NumStoreConstraints += Stats.Stores;
+  NumSolverRounds += Stats.Rounds;
+  NumPointsToFacts += Stats.Facts;
+  NumPointsToSets += Stats.Sets;
+  NumCollapsedObjects += Stats.Collapsed;
+  if (!Stats.Largest.empty())
+    MaxPointsToSetSize.updateMax(Stats.Largest.front().second);
+}
+
+ArrayRef<TrackingStatistic*> DoubleFreePointerAnalysis::statistics() {
+  static TrackingStatistic* const Statistics[] = {&NumAllocConstraints, &NumCopyConstraints,
+      &NumLoadConstraints, &NumStoreConstraints, &NumSolverRounds, &NumPointsToFacts,
+      &NumPointsToSets, &NumCollapsedObjects, &MaxPointsToSetSize};
+  return Statistics;
+}
+
+void DoubleFreePointerAnalysis::printStats(raw_ostream& OS) const {
+  json::Array Histogram;
+  for (unsigned Count : Stats.Histogram)
+    Histogram.push_back(Count);
+  json::Array Largest;
+  for (auto& I : Stats.Largest)
+    Largest.push_back(json::Object{{"name", StringRef(I.first).rtrim()}, {"size", int64_t(I.second)}});
+
+  json::Object Record{
+      {"function", Func->getName()},
+      {"constraints",
+          json::Object{{"alloc", Stats.Allocs},
+              {"copy", Stats.Copies},
+              {"load", Stats.Loads},
+              {"store", Stats.Stores}}},
+      {"rounds", Stats.Rounds},
+      {"variables", int64_t(Stats.Variables)},
+      {"facts", int64_t(Stats.Facts)},
+      {"sets", int64_t(Stats.Sets)},
+      {"field_sites", int64_t(Stats.FieldSites)},
+      {"collapsed", int64_t(Stats.Collapsed)},
+      {"histogram", std::move(Histogram)},
+      {"largest", std::move(Largest)},
+      {"ms", json::Object{{"solve", Stats.SolveMs}, {"index", Stats.IndexMs}}},
+      {"pool_bytes", int64_t(Stats.PoolBytes)},
+  };
+  OS << json::Value(std::move(Record)) << "\n";
+}
+
+SetID DoubleFreePointerAnalysis::lookup(const std::string& Name) const {
+  auto It = PointsTo.find(Name);
+  return It == PointsTo.end() ? PointsToSetPool::Empty : It->second;
+}
+
+SetID DoubleFreePointerAnalysis::access(Instruction* Inst, Value* Pointer) {
+  SetID Sites = lookup(variable(Pointer));
+  SetID& Known = Accessed[Inst];
+  std::vector<SiteID> New = Pool.elements(Pool.setDifference(Sites, Known));
+  for (SiteID S : New) {
+    Accessors[canonical(S)].insert(Inst);
+  }
+  Known = Pool.setUnion(Known, Sites);
+  return Sites;
+}
+
+void DoubleFreePointerAnalysis::buildAccessorIndex() {
+  if (Indexed)
+    return;
+  Indexed = true;
+
+  for (inst_iterator Iter = inst_begin(*Func), E = inst_end(*Func); Iter != E; ++Iter) {
+    if (auto* Load = dyn_cast<LoadInst>(&*Iter)) {
+      if (Load->getType()->isPointerTy())
+        access(Load, Load->getPointerOperand());
+    } else if (auto* Store = dyn_cast<StoreInst>(&*Iter)) {
+      if (Store->getValueOperand()->getType()->isPointerTy())
+        access(Store, Store->getPointerOperand());
+    }
   }
-  print(PointsTo);
+}
+
+void DoubleFreePointerAnalysis::reindex(const std::string& Name, SetID Old, SetID New) {
+  if (PointedBy.size() < Pool.numSites())
+    PointedBy.resize(Pool.numSites());
+
+  std::vector<SiteID> Removed = Pool.elements(Pool.setDifference(Old, New));
+  std::vector<SiteID> Added = Pool.elements(Pool.setDifference(New, Old));
+  for (SiteID S : Removed) {
+    std::vector<const std::string*>& Names = PointedBy[S];
+    auto It = std::find(Names.begin(), Names.end(), &Name);
+    if (It != Names.end())
+      Names.erase(It);
+  }
+  for (SiteID S : Added) {
+    std::vector<const std::string*>& Names = PointedBy[S];
+    if (std::find(Names.begin(), Names.end(), &Name) == Names.end())
+      Names.push_back(&Name);
+  }
+}
+
+void DoubleFreePointerAnalysis::propagate(std::vector<Instruction*> Insts) {
+  std::deque<Instruction*> WorkList(Insts.begin(), Insts.end());
+  std::set<Instruction*> Pending(Insts.begin(), Insts.end());
+  auto Push = [&](Instruction* Inst) {
+    if (Pending.insert(Inst).second)
+      WorkList.push_back(Inst);
+  };
+
+  while (!WorkList.empty()) {
+    Instruction* Inst = WorkList.front();
+    WorkList.pop_front();
+    Pending.erase(Inst);
+    if (Retracted.count(Inst))
+      continue;
+    Evaluated++;
+
+    if (auto* Store = dyn_cast<StoreInst>(Inst)) {
+      if (!Store->getValueOperand()->getType()->isPointerTy())
+        continue;
+
+      // What the written sites held before, to find the loads to revisit
+      std::vector<std::pair<SiteID, SetID>> Old;
+      for (SiteID S : Pool.elements(access(Store, Store->getPointerOperand()))) {
+        Old.push_back({canonical(S), PointsToSetPool::Empty});
+      }
+      for (auto& I : Old) {
+        I.second = lookup(Pool.siteName(I.first));
+      }
+      transfer(Store, PointsTo);
+      for (auto& I : Old) {
+        if (lookup(Pool.siteName(I.first)) == I.second)
+          continue;
+        for (Instruction* Reader : Accessors[I.first]) {
+          if (isa<LoadInst>(Reader))
+            Push(Reader);
+        }
+      }
+      continue;
+    }
+
+    if (!Inst->getType()->isPointerTy())
+      continue;
+    if (auto* Load = dyn_cast<LoadInst>(Inst))
+      access(Load, Load->getPointerOperand());
+
+    std::string Name = variable(Inst);
+    SetID Old = lookup(Name);
+    transfer(Inst, PointsTo);
+    auto It = PointsTo.find(Name);
+    if (It == PointsTo.end() || It->second == Old)
+      continue;
+    reindex(It->first, Old, It->second);
+    for (User* U : Inst->users()) {
+      if (auto* I = dyn_cast<Instruction>(U))
+        Push(I);
+    }
+  }
+}
+
+void DoubleFreePointerAnalysis::removeInstructions(ArrayRef<Instruction*> Insts) {
+  buildAccessorIndex();
+  clearAliasCache();
+  Evaluated = 0;
+  Retracted.insert(Insts.begin(), Insts.end());
+
+  // Over-delete: the sites a variable or the contents of a site lost, to be
+  // removed in turn from whatever was derived from them
+  std::vector<std::pair<Instruction*, SetID>> LostVars;
+  std::vector<std::pair<SiteID, SetID>> LostContents;
+  // Instructions that may derive the over-deleted facts again
+  std::set<Instruction*> Rederive;
+
+  auto LoseVar = [&](Instruction* Inst, SetID Lost) {
+    if (Retracted.count(Inst))
+      return;
+    auto It = PointsTo.find(variable(Inst));
+    if (It == PointsTo.end())
+      return;
+    SetID Removed = Pool.setIntersection(It->second, Lost);
+    if (Removed == PointsToSetPool::Empty)
+      return;
+    SetID Old = It->second;
+    It->second = Pool.setDifference(Old, Removed);
+    reindex(It->first, Old, It->second);
+    Rederive.insert(Inst);
+    LostVars.push_back({Inst, Removed});
+  };
+  auto LoseContents = [&](SiteID Site, SetID Lost) {
+    auto It = PointsTo.find(Pool.siteName(Site));
+    if (It == PointsTo.end())
+      return;
+    SetID Removed = Pool.setIntersection(It->second, Lost);
+    if (Removed == PointsToSetPool::Empty)
+      return;
+    It->second = Pool.setDifference(It->second, Removed);
+    for (Instruction* Writer : Accessors[Site]) {
+      if (isa<StoreInst>(Writer))
+        Rederive.insert(Writer);
+    }
+    LostContents.push_back({Site, Removed});
+  };
+
+  for (Instruction* Inst : Insts) {
+    auto It = Accessed.find(Inst);
+    if (It != Accessed.end()) {
+      std::vector<SiteID> Sites = Pool.elements(It->second);
+      Accessed.erase(It);
+      for (SiteID S : Sites) {
+        Accessors[canonical(S)].erase(Inst);
+      }
+      // The sites the store was registered for cover those it wrote to
+      if (auto* Store = dyn_cast<StoreInst>(Inst)) {
+        SetID Value = lookup(variable(Store->getValueOperand()));
+        for (SiteID S : Sites) {
+          LoseContents(canonical(S), Value);
+        }
+      }
+    }
+
+    if (!Inst->getType()->isPointerTy())
+      continue;
+    auto Var = PointsTo.find(variable(Inst));
+    if (Var == PointsTo.end())
+      continue;
+    SetID Lost = Var->second;
+    reindex(Var->first, Lost, PointsToSetPool::Empty);
+    PointsTo.erase(Var);
+    LostVars.push_back({Inst, Lost});
+  }
+
+  while (!LostVars.empty() || !LostContents.empty()) {
+    if (!LostContents.empty()) {
+      auto [Site, Lost] = LostContents.back();
+      LostContents.pop_back();
+      std::vector<Instruction*> Readers(Accessors[Site].begin(), Accessors[Site].end());
+      for (Instruction* Reader : Readers) {
+        if (isa<LoadInst>(Reader))
+          LoseVar(Reader, Lost);
+      }
+      continue;
+    }
+
+    auto [Inst, Lost] = LostVars.back();
+    LostVars.pop_back();
+    for (User* U : Inst->users()) {
+      auto* User = dyn_cast<Instruction>(U);
+      if (!User || Retracted.count(User))
+        continue;
+
+      if (auto* Store = dyn_cast<StoreInst>(User)) {
+        if (!Store->getValueOperand()->getType()->isPointerTy())
+          continue;
+        if (Store->getPointerOperand() == Inst) {
+          SetID Value = lookup(variable(Store->getValueOperand()));
+          std::vector<SiteID> Sites = Pool.elements(Lost);
+          for (SiteID S : Sites) {
+            LoseContents(canonical(S), Value);
+          }
+        }
+        if (Store->getValueOperand() == Inst) {
+          std::vector<SiteID> Sites = Pool.elements(Accessed[Store]);
+          for (SiteID S : Sites) {
+            LoseContents(canonical(S), Lost);
+          }
+        }
+      } else if (auto* Load = dyn_cast<LoadInst>(User)) {
+        if (!Load->getType()->isPointerTy())
+          continue;
+        SetID Loaded = PointsToSetPool::Empty;
+        std::vector<SiteID> Sites = Pool.elements(Lost);
+        for (SiteID S : Sites) {
+          Loaded = Pool.setUnion(Loaded, lookup(Pool.siteName(canonical(S))));
+        }
+        LoseVar(Load, Loaded);
+      } else if (auto* GEP = dyn_cast<GetElementPtrInst>(User)) {
+        if (!GEP->getType()->isPointerTy())
+          continue;
+        // Fields of the lost sites may be shared with other bases, so a
+        // GEP selecting a field loses its whole set
+        if (MaxFields <= 1 || fieldOffset(GEP) == 0)
+          LoseVar(GEP, Lost);
+        else
+          LoseVar(GEP, lookup(variable(GEP)));
+      } else if (isa<CastInst>(User) || isa<PHINode>(User)) {
+        if (User->getType()->isPointerTy())
+          LoseVar(User, Lost);
+      }
+    }
+  }
+
+  // Re-derive: the instructions that produced over-deleted facts evaluate
+  // their constraints again from what is left
+  propagate(std::vector<Instruction*>(Rederive.begin(), Rederive.end()));
+}
+
+void DoubleFreePointerAnalysis::addInstructions(ArrayRef<Instruction*> Insts) {
+  buildAccessorIndex();
+  clearAliasCache();
+  Evaluated = 0;
+  // Retracted instructions not added back were erased by the edit
+  Retracted.clear();
+
+  propagate(std::vector<Instruction*>(Insts.begin(), Insts.end()));
+
+  // A collapse changes the sites of the whole function
+  if (CollapseChanged) {
+    CollapseChanged = false;
+    PointsTo.clear();
+    Accessors.clear();
+    Accessed.clear();
+    Indexed = false;
+    solve(PointsTo);
+    buildInverseIndex(*Func);
+    buildAccessorIndex();
+  }
+}
+
+bool DoubleFreePointerAnalysis::verify() {
+  std::vector<std::string> CollapsedNames;
+  for (SiteID S : Collapsed)
+    CollapsedNames.push_back(Pool.siteName(S));
+  DoubleFreePointerAnalysis Fresh(*Func, MaxFields, Retracted, CollapsedNames);
+
+  // The two pools number sites and sets apart, so sets compare by site name
+  auto Names = [](const PointsToSetPool& Pool, SetID Set) {
+    std::vector<std::string> Sites;
+    for (SiteID S : Pool.elements(Set))
+      Sites.push_back(Pool.siteName(S));
+    std::sort(Sites.begin(), Sites.end());
+    return Sites;
+  };
+  // Either solution may hold empty entries for names the other never saw
+  auto Covers = [&](const DoubleFreePointerAnalysis& A, const DoubleFreePointerAnalysis& B) {
+    for (auto& I : A.PointsTo) {
+      if (I.second == PointsToSetPool::Empty)
+        continue;
+      auto It = B.PointsTo.find(I.first);
+      if (It == B.PointsTo.end() || Names(A.Pool, I.second) != Names(B.Pool, It->second))
+        return false;
+    }
+    return true;
+  };
+  if (!Covers(*this, Fresh) || !Covers(Fresh, *this))
+    return false;
+
+  // The inverse index kept up by reindex() must be the one built from scratch
+  auto Index = [](const DoubleFreePointerAnalysis& A) {
+    std::map<std::string, std::vector<std::string>> Index;
+    for (SiteID S = 0; S < A.PointedBy.size(); ++S) {
+      if (A.PointedBy[S].empty())
+        continue;
+      std::vector<std::string>& Found = Index[A.Pool.siteName(S)];
+      for (const std::string* Name : A.PointedBy[S])
+        Found.push_back(*Name);
+      std::sort(Found.begin(), Found.end());
+    }
+    return Index;
+  };
+  return Index(*this) == Index(Fresh);
 }
 
 bool DoubleFreePointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
-  if (PointsTo.find(Ptr1) == PointsTo.end() || PointsTo.find(Ptr2) == PointsTo.end())
+  auto It1 = PointsTo.find(Ptr1);
+  auto It2 = PointsTo.find(Ptr2);
+  if (It1 == PointsTo.end() || It2 == PointsTo.end())
     return false;
-  const PointsToSet& S1 = PointsTo.at(Ptr1);
-  const PointsToSet& S2 = PointsTo.at(Ptr2);
 
-  PointsToSet Inter;
-  std::set_intersection(
-      S1.begin(), S1.end(), S2.begin(), S2.end(), std::inserter(Inter, Inter.begin()));
-  return !Inter.empty();
+  // Stops at the first common site, without building the intersection
+  if (Pool.intersects(It1->second, It2->second))
+    return true;
+  if (FieldOf.empty())
+    return false;
+
+  // A pointer to a field and a pointer to its object
+  std::vector<SiteID> Sites;
+  for (SiteID S : Pool.elements(It1->second))
+    aliasSites(S, Sites);
+  std::sort(Sites.begin(), Sites.end());
+  for (SiteID S : Pool.elements(It2->second)) {
+    if (std::binary_search(Sites.begin(), Sites.end(), S))
+      return true;
+  }
+  return false;
+}
+
+std::vector<std::string> DoubleFreePointerAnalysis::aliases(const std::string& Ptr) const {
+  auto It = PointsTo.find(Ptr);
+  if (It == PointsTo.end())
+    return {};
+
+  // A pointer sharing several sites with Ptr is found once per site
+  std::vector<SiteID> Sites;
+  for (SiteID S : Pool.elements(It->second))
+    aliasSites(S, Sites);
+  std::vector<const std::string*> Found;
+  for (SiteID S : Sites) {
+    for (const std::string* Name : PointedBy[S]) {
+      if (Name != &It->first)
+        Found.push_back(Name);
+    }
+  }
+  std::sort(Found.begin(), Found.end());
+  Found.erase(std::unique(Found.begin(), Found.end()), Found.end());
+
+  std::vector<std::string> Result;
+  Result.reserve(Found.size());
+  for (const std::string* Name : Found)
+    Result.push_back(*Name);
+  return Result;
 }
 
 };  // namespace dataflow
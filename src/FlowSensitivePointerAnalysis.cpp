@@ -0,0 +1,406 @@
+#include "FlowSensitivePointerAnalysis.h"
+
+#include "Utils.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/AssumptionCache.h"
+#include "llvm/Analysis/BasicAliasAnalysis.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+
+#include <algorithm>
+
+namespace dataflow {
+
+/**
+ * @brief Whether a store through Ptr overwrites all of what its object
+ * holds: Ptr is the stack slot or global itself, or a constant offset 0
+ * into it, and the object is not an aggregate whose other elements the
+ * store leaves alone.
+ */
+static bool writesWholeObject(const Value* Ptr, const DataLayout& DL) {
+  APInt Offset(DL.getIndexTypeSizeInBits(Ptr->getType()), 0);
+  const Value* Base = Ptr->stripAndAccumulateConstantOffsets(DL, Offset,
+      /*AllowNonInbounds=*/true);
+  if (!Offset.isZero())
+    return false;
+  if (auto* Alloca = dyn_cast<AllocaInst>(Base))
+    return !Alloca->getAllocatedType()->isAggregateType();
+  if (auto* Global = dyn_cast<GlobalVariable>(Base))
+    return !Global->getValueType()->isAggregateType();
+  return false;
+}
+
+FlowSensitivePointerAnalysis::NodeID FlowSensitivePointerAnalysis::node(const Value* V) {
+  if (isa<Constant>(V)) {
+    V = stripConstant(V);
+    // Null, undef and integer constants point nowhere
+    if (!isa<GlobalValue>(V))
+      return NoNode;
+  }
+
+  auto It = ValueNodes.find(V);
+  if (It != ValueNodes.end())
+    return It->second;
+
+  NodeID N = PointsTo.size();
+  PointsTo.emplace_back();
+  ValueNodes[V] = N;
+  // A global names its own storage, of which there is exactly one
+  if (isa<GlobalValue>(V))
+    AddressOf.push_back({N, site(V, isa<GlobalVariable>(V))});
+  return N;
+}
+
+FlowSensitivePointerAnalysis::SiteID FlowSensitivePointerAnalysis::site(
+    const Value* V, bool IsSingleton) {
+  auto It = SiteIDs.find(V);
+  if (It != SiteIDs.end())
+    return It->second;
+
+  SiteID Site = Singleton.size();
+  SiteIDs[V] = Site;
+  Singleton.push_back(IsSingleton);
+  return Site;
+}
+
+void FlowSensitivePointerAnalysis::collect(Instruction* Inst, MemorySSA& MSSA) {
+  if (auto* Alloca = dyn_cast<AllocaInst>(Inst)) {
+    // Outside the entry block an alloca may run several times, and every
+    // run is a different object
+    bool IsSingleton =
+        Alloca->getParent()->isEntryBlock() && !Alloca->isArrayAllocation();
+    AddressOf.push_back({node(Alloca), site(Alloca, IsSingleton)});
+
+  } else if (auto* Store = dyn_cast<StoreInst>(Inst)) {
+    if (!Store->getValueOperand()->getType()->isPointerTy())
+      return;
+    NodeID Ptr = node(Store->getPointerOperand());
+    if (Ptr == NoNode)
+      return;
+    auto* Def = cast<MemoryDef>(MSSA.getMemoryAccess(Store));
+    StoreOf[Def] = Stores.size();
+    Stores.push_back({Ptr, node(Store->getValueOperand()), Def, {},
+        writesWholeObject(Store->getPointerOperand(), Store->getModule()->getDataLayout())});
+
+  } else if (auto* Load = dyn_cast<LoadInst>(Inst)) {
+    if (!Load->getType()->isPointerTy())
+      return;
+    NodeID Ptr = node(Load->getPointerOperand());
+    NodeID Dst = node(Load);
+    if (Ptr == NoNode)
+      return;
+    // Uses are already optimized to their clobbering access by MemorySSA
+    Loads.push_back({Dst, Ptr, MSSA.getMemoryAccess(Load)->getDefiningAccess()});
+
+  } else if (auto* Call = dyn_cast<CallBase>(Inst)) {
+    if (Call->getType()->isPointerTy())
+      AddressOf.push_back({node(Call), site(Call, false)});
+
+  } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
+    if (Cast->getType()->isPointerTy() && Cast->getOperand(0)->getType()->isPointerTy()) {
+      NodeID Src = node(Cast->getOperand(0));
+      if (Src != NoNode)
+        Copies.push_back({Src, node(Cast)});
+    }
+
+  } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
+    NodeID Src = node(GEP->getPointerOperand());
+    if (Src != NoNode)
+      Copies.push_back({Src, node(GEP)});
+
+  } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
+    if (!Phi->getType()->isPointerTy())
+      return;
+    NodeID Dst = node(Phi);
+    for (Value* Incoming : Phi->incoming_values()) {
+      NodeID Src = node(Incoming);
+      if (Src != NoNode)
+        Copies.push_back({Src, Dst});
+    }
+
+  } else if (auto* Select = dyn_cast<SelectInst>(Inst)) {
+    if (!Select->getType()->isPointerTy())
+      return;
+    NodeID Dst = node(Select);
+    for (Value* Op : {Select->getTrueValue(), Select->getFalseValue()}) {
+      NodeID Src = node(Op);
+      if (Src != NoNode)
+        Copies.push_back({Src, Dst});
+    }
+  }
+}
+
+void FlowSensitivePointerAnalysis::preSolve() {
+  // Flow-insensitive: one content set per site for the whole function
+  std::vector<SiteSet> Stored(Singleton.size());
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto& [Src, Dst] : Copies)
+      Changed |= PointsTo[Dst] |= PointsTo[Src];
+    for (auto& Load : Loads) {
+      for (SiteID Site : PointsTo[Load.Ptr])
+        Changed |= PointsTo[Load.Dst] |= Stored[Site];
+    }
+    for (auto& Store : Stores) {
+      if (Store.Val == NoNode)
+        continue;
+      for (SiteID Site : PointsTo[Store.Ptr])
+        Changed |= Stored[Site] |= PointsTo[Store.Val];
+    }
+  }
+}
+
+unsigned FlowSensitivePointerAnalysis::reachingDef(
+    const MemoryAccess* Access, SiteID Site, const MemorySSA& MSSA) {
+  // Every access on the way up reaches the same definition, so the whole
+  // walk is memoized and chains of unrelated stores are skipped once.
+  SmallVector<const MemoryAccess*, 8> Walked;
+  unsigned Result = NoNode;
+  while (!MSSA.isLiveOnEntryDef(Access)) {
+    auto It = Reaching.find({Access, Site});
+    if (It != Reaching.end()) {
+      Result = It->second;
+      break;
+    }
+    Walked.push_back(Access);
+
+    if (auto* Phi = dyn_cast<MemoryPhi>(Access)) {
+      auto [Node, New] = MemoryNodeOf.try_emplace({Phi, Site}, MemoryNodes.size());
+      if (New) {
+        MemoryNodes.push_back({Phi, NoNode, Site, {}});
+        PendingPhis.push_back(Node->second);
+      }
+      Result = Node->second;
+      break;
+    }
+
+    auto* Def = cast<MemoryDef>(Access);
+    auto Store = StoreOf.find(Def);
+    if (Store != StoreOf.end() && Stores[Store->second].May.test(Site)) {
+      Result = MemoryNodeOf.lookup({Def, Site});
+      break;
+    }
+    Access = Def->getDefiningAccess();
+  }
+
+  for (const MemoryAccess* A : Walked)
+    Reaching[{A, Site}] = Result;
+  return Result;
+}
+
+void FlowSensitivePointerAnalysis::buildMemoryGraph(const MemorySSA& MSSA) {
+  for (unsigned i = 0; i < Stores.size(); ++i) {
+    Stores[i].May = PointsTo[Stores[i].Ptr];
+    for (SiteID Site : Stores[i].May) {
+      MemoryNodeOf[{Stores[i].Def, Site}] = MemoryNodes.size();
+      MemoryNodes.push_back({Stores[i].Def, i, Site, {}});
+    }
+  }
+
+  // A store that may write a site also passes on its old contents
+  unsigned NumStoreNodes = MemoryNodes.size();
+  for (unsigned N = 0; N < NumStoreNodes; ++N) {
+    const MemoryDef* Def = Stores[MemoryNodes[N].Store].Def;
+    unsigned In = reachingDef(Def->getDefiningAccess(), MemoryNodes[N].Site, MSSA);
+    if (In != NoNode)
+      MemoryNodes[N].In.push_back(In);
+  }
+
+  // The main analysis only looks up sites from the pre-analysis
+  for (auto& Load : Loads) {
+    for (SiteID Site : PointsTo[Load.Ptr])
+      reachingDef(Load.In, Site, MSSA);
+  }
+
+  // Connecting a phi may reach further phis
+  while (!PendingPhis.empty()) {
+    unsigned N = PendingPhis.back();
+    PendingPhis.pop_back();
+
+    auto* Phi = cast<MemoryPhi>(MemoryNodes[N].Access);
+    SiteID Site = MemoryNodes[N].Site;
+    SmallVector<unsigned, 2> In;
+    for (const Use& Incoming : Phi->incoming_values()) {
+      unsigned Def = reachingDef(cast<MemoryAccess>(Incoming), Site, MSSA);
+      if (Def != NoNode)
+        In.push_back(Def);
+    }
+    MemoryNodes[N].In = std::move(In);
+  }
+
+  Users.resize(MemoryNodes.size());
+  for (unsigned N = 0; N < MemoryNodes.size(); ++N) {
+    for (unsigned In : MemoryNodes[N].In)
+      Users[In].push_back(N);
+  }
+}
+
+void FlowSensitivePointerAnalysis::solveMemory() {
+  // The pointers are fixed here, so contents only grow
+  Contents.assign(MemoryNodes.size(), SiteSet());
+  std::vector<unsigned> WorkList;
+  std::vector<bool> InWorkList(MemoryNodes.size(), true);
+  for (unsigned N = MemoryNodes.size(); N-- > 0;)
+    WorkList.push_back(N);
+
+  while (!WorkList.empty()) {
+    unsigned N = WorkList.back();
+    WorkList.pop_back();
+    InWorkList[N] = false;
+
+    const MemoryNode& Node = MemoryNodes[N];
+    SiteSet New;
+    bool Kill = false;
+    if (Node.Store != NoNode) {
+      const StoreConstraint& Store = Stores[Node.Store];
+      const SiteSet& Ptr = PointsTo[Store.Ptr];
+      if (Ptr.test(Node.Site)) {
+        if (Store.Val != NoNode)
+          New = PointsTo[Store.Val];
+        // The store must write this very object, and all of it
+        Kill = Store.Whole && Singleton[Node.Site] && Ptr.count() == 1;
+      }
+    }
+    if (!Kill) {
+      for (unsigned In : Node.In)
+        New |= Contents[In];
+    }
+
+    if (Contents[N] |= New) {
+      for (unsigned User : Users[N]) {
+        if (!InWorkList[User]) {
+          InWorkList[User] = true;
+          WorkList.push_back(User);
+        }
+      }
+    }
+  }
+}
+
+void FlowSensitivePointerAnalysis::solve() {
+  // Pointers loaded from memory may change the sites of later stores, so
+  // memory is solved again until the pointers are stable. Pointers only
+  // grow: contents loaded before a pointer was known stay, which keeps the
+  // result sound.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    bool CopyChanged = true;
+    while (CopyChanged) {
+      CopyChanged = false;
+      for (auto& [Src, Dst] : Copies)
+        CopyChanged |= PointsTo[Dst] |= PointsTo[Src];
+    }
+
+    solveMemory();
+
+    for (auto& Load : Loads) {
+      for (SiteID Site : PointsTo[Load.Ptr]) {
+        // No entry: only the contents on entry, which are unknown and empty
+        auto Def = Reaching.find({Load.In, Site});
+        if (Def != Reaching.end() && Def->second != NoNode)
+          Changed |= PointsTo[Load.Dst] |= Contents[Def->second];
+      }
+    }
+  }
+}
+
+void FlowSensitivePointerAnalysis::buildIndex(Function& F) {
+  for (auto& Arg : F.args()) {
+    auto It = ValueNodes.find(&Arg);
+    if (It != ValueNodes.end())
+      Names[variable(&Arg)] |= PointsTo[It->second];
+  }
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    auto It = ValueNodes.find(&*Iter);
+    if (It != ValueNodes.end())
+      Names[variable(&*Iter)] |= PointsTo[It->second];
+  }
+
+  for (auto& I : Names) {
+    for (unsigned Site : I.second)
+      PointedBy[Site].push_back(&I.first);
+  }
+}
+
+FlowSensitivePointerAnalysis::FlowSensitivePointerAnalysis(Function& F) {
+  // MemorySSA over BasicAA, which already skips stores that provably write
+  // another location
+  const DataLayout& DL = F.getParent()->getDataLayout();
+  DominatorTree DT(F);
+  TargetLibraryInfoImpl TLII(Triple(F.getParent()->getTargetTriple()));
+  TargetLibraryInfo TLI(TLII);
+  AssumptionCache AC(F);
+  BasicAAResult BasicAA(DL, F, TLI, AC, &DT);
+  AAResults AA(TLI);
+  AA.addAAResult(BasicAA);
+  MemorySSA MSSA(F, &AA, &DT);
+
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy())
+      AddressOf.push_back({node(&Arg), site(&Arg, false)});
+  }
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    collect(&*Iter, MSSA);
+  }
+
+  for (auto& [N, Site] : AddressOf)
+    PointsTo[N].set(Site);
+  preSolve();
+  buildMemoryGraph(MSSA);
+
+  // Start over from the address-of facts; only the memory graph is kept
+  for (auto& Set : PointsTo)
+    Set.clear();
+  for (auto& [N, Site] : AddressOf)
+    PointsTo[N].set(Site);
+  solve();
+  buildIndex(F);
+}
+
+size_t FlowSensitivePointerAnalysis::numMemoryNodes() const {
+  return MemoryNodes.size();
+}
+
+size_t FlowSensitivePointerAnalysis::numMemoryEdges() const {
+  size_t Edges = 0;
+  for (auto& Node : MemoryNodes)
+    Edges += Node.In.size();
+  return Edges;
+}
+
+bool FlowSensitivePointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
+  auto It1 = Names.find(Ptr1);
+  auto It2 = Names.find(Ptr2);
+  if (It1 == Names.end() || It2 == Names.end())
+    return false;
+  return It1->second.intersects(It2->second);
+}
+
+std::vector<std::string> FlowSensitivePointerAnalysis::aliases(const std::string& Ptr) const {
+  auto It = Names.find(Ptr);
+  if (It == Names.end())
+    return {};
+
+  std::vector<const std::string*> Found;
+  for (unsigned Site : It->second) {
+    for (const std::string* Name : PointedBy.at(Site)) {
+      if (Name != &It->first)
+        Found.push_back(Name);
+    }
+  }
+  std::sort(Found.begin(), Found.end());
+  Found.erase(std::unique(Found.begin(), Found.end()), Found.end());
+
+  std::vector<std::string> Result;
+  for (const std::string* Name : Found)
+    Result.push_back(*Name);
+  return Result;
+}
+
+}  // namespace dataflow
@@ -0,0 +1,634 @@
+#include "FunctionSummary.h"
+
+#include "AnalysisCache.h"
+#include "SummaryIndex.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SCCIterator.h"
+#include "llvm/Analysis/CallGraph.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Threading.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Function Summaries Implementation
+//===----------------------------------------------------------------------===//
+
+static bool isAllocation(StringRef Name) {
+  return Name.equals("malloc") || Name.equals("calloc") || Name.equals("realloc");
+}
+
+/**
+ * @brief Whether the only uses of Slot are loads from and stores to it, so
+ * that its content is exactly what the function stores into it.
+ */
+static bool isTrackedSlot(const AllocaInst* Slot) {
+  for (const User* U : Slot->users()) {
+    if (auto* Load = dyn_cast<LoadInst>(U)) {
+      if (Load->getPointerOperand() != Slot)
+        return false;
+    } else if (auto* Store = dyn_cast<StoreInst>(U)) {
+      if (Store->getPointerOperand() != Slot || Store->getValueOperand() == Slot)
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Set in Fact the parameters among the origins O.
+ */
+static void addParams(BitVector& Fact, const BitVector& O) {
+  for (unsigned k : O.set_bits()) {
+    if (k >= Fact.size())
+      break;
+    Fact.set(k);
+  }
+}
+
+void FunctionSummary::print(raw_ostream& O) const {
+  auto PrintParams = [&](const char* Name, const BitVector& Params) {
+    O << Name << " {";
+    const char* Sep = "";
+    for (unsigned k : Params.set_bits()) {
+      O << Sep << k;
+      Sep = ", ";
+    }
+    O << "}";
+  };
+  PrintParams("frees", Frees);
+  PrintParams(", derefs", Derefs);
+  PrintParams(", escapes", Escapes);
+  if (ReturnsFresh)
+    O << ", returns fresh";
+}
+
+void FunctionSummary::serialize(std::vector<uint32_t>& Words) const {
+  unsigned NumParams = Frees.size();
+  Words.push_back(NumParams);
+  Words.push_back(ReturnsFresh);
+  for (const BitVector* Params : {&Frees, &Derefs, &Escapes}) {
+    size_t First = Words.size();
+    Words.resize(First + (NumParams + 31) / 32);
+    for (unsigned k : Params->set_bits())
+      Words[First + k / 32] |= 1u << (k % 32);
+  }
+}
+
+bool FunctionSummary::deserialize(ArrayRef<uint32_t>& Words) {
+  if (Words.size() < 2)
+    return false;
+  unsigned NumParams = Words[0];
+  size_t NumWords = (size_t(NumParams) + 31) / 32;
+  if (Words.size() < 2 + 3 * NumWords)
+    return false;
+  ReturnsFresh = Words[1];
+  Words = Words.drop_front(2);
+
+  for (BitVector* Params : {&Frees, &Derefs, &Escapes}) {
+    Params->clear();
+    Params->resize(NumParams);
+    for (unsigned k = 0; k < NumParams; ++k) {
+      if (Words[k / 32] & (1u << (k % 32)))
+        Params->set(k);
+    }
+    Words = Words.drop_front(NumWords);
+  }
+  return true;
+}
+
+FunctionSummaries::FunctionSummaries(Module& M) : M(&M) {
+  CallGraph CG(M);
+
+  DenseMap<const Function*, unsigned> SCCOf;
+  for (auto It = scc_begin(&CG); !It.isAtEnd(); ++It) {
+    SCCNode SCC;
+    for (CallGraphNode* Node : *It) {
+      Function* F = Node->getFunction();
+      if (F && !F->isDeclaration())
+        SCC.Members.push_back(F);
+    }
+    if (SCC.Members.empty())
+      continue;
+
+    SCC.Recursive = It.hasCycle();
+    for (Function* F : SCC.Members) {
+      SCCOf[F] = SCCs.size();
+      Index[F] = Summaries.size();
+      Summaries.emplace_back();
+    }
+    SCCs.push_back(std::move(SCC));
+  }
+
+  // Only direct calls read the summary of another function
+  for (unsigned i = 0; i < SCCs.size(); ++i) {
+    DenseSet<unsigned> Callees;
+    for (Function* F : SCCs[i].Members) {
+      for (auto& I : instructions(*F)) {
+        auto* Call = dyn_cast<CallBase>(&I);
+        auto It = Call ? SCCOf.find(Call->getCalledFunction()) : SCCOf.end();
+        if (It != SCCOf.end() && It->second != i && Callees.insert(It->second).second)
+          SCCs[It->second].Callers.push_back(i);
+      }
+    }
+    SCCs[i].NumCallees = Callees.size();
+  }
+}
+
+void FunctionSummaries::compute(unsigned Threads, bool Verify, AnalysisCache* Cache) {
+  if (Computed)
+    return;
+  Computed = true;
+
+  Threads = hardware_concurrency(Threads).compute_thread_count();
+  if (Threads <= 1 || SCCs.size() < 2) {
+    // Components come callees first
+    for (const SCCNode& SCC : SCCs)
+      summarizeSCC(SCC, Cache);
+  } else {
+    summarizeParallel(Threads, Cache);
+  }
+
+  if (Verify && (Threads > 1 || Cache) && !matchesSequential())
+    report_fatal_error("function summaries differ from the uncached sequential ones");
+}
+
+unsigned FunctionSummaries::import(const SummaryIndex& Imports) {
+  unsigned Count = 0;
+  for (Function& F : *M) {
+    if (!F.isDeclaration() || F.isIntrinsic())
+      continue;
+    const FunctionSummary* S = Imports.lookup(indexName(F));
+    // A declaration of another type is not the function of the index
+    if (!S || S->Frees.size() != F.arg_size())
+      continue;
+    // The same index given to several passes of the pipeline changes nothing
+    // once imported, but any other summary comes too late for the callers
+    // already summarized without it
+    auto It = Index.find(&F);
+    bool Same = It != Index.end() && Summaries[It->second] == *S;
+    if (Computed && !Same) {
+      report_fatal_error("summary index imported after the function summaries were "
+                         "computed; give index= to the first pass that uses them");
+    }
+    if (It != Index.end())
+      continue;
+    Index[&F] = Summaries.size();
+    Summaries.push_back(*S);
+    Imported.push_back(&F);
+    Count++;
+  }
+  return Count;
+}
+
+void FunctionSummaries::exportTo(SummaryIndex& Exports) const {
+  for (const SCCNode& SCC : SCCs) {
+    for (Function* F : SCC.Members) {
+      std::vector<SummaryEdge> Edges;
+      summarize(*F, &Edges);
+      Exports.add(indexName(*F), Summaries[Index.lookup(F)], std::move(Edges));
+    }
+  }
+}
+
+bool FunctionSummaries::matchesSequential() const {
+  FunctionSummaries Sequential(*M);
+  for (const Function* F : Imported) {
+    Sequential.Index[F] = Sequential.Summaries.size();
+    Sequential.Summaries.push_back(*lookup(F));
+  }
+  Sequential.compute(1);
+  return sameSummaries(Sequential);
+}
+
+void FunctionSummaries::summarizeParallel(unsigned Threads, AnalysisCache* Cache) {
+  // A component is ready once all the components it calls are done. The
+  // thread finishing the last of them queues it; the decrement orders those
+  // summaries before its reads.
+  std::unique_ptr<std::atomic<unsigned>[]> Pending(new std::atomic<unsigned>[SCCs.size()]);
+  for (unsigned i = 0; i < SCCs.size(); ++i)
+    Pending[i].store(SCCs[i].NumCallees, std::memory_order_relaxed);
+
+  // Each worker takes the components it made ready from the back of its own
+  // deque, so a caller usually runs right after its callees on the same
+  // thread. An idle worker steals from the front of the others' deques,
+  // where the oldest and usually widest parts of the call graph wait.
+  struct Worker {
+    std::mutex Lock;
+    std::deque<unsigned> Ready;
+  };
+  std::vector<Worker> Workers(Threads);
+  // Components not summarized yet, and queued but not taken yet. Idle
+  // workers sleep on Wake until either changes, both under IdleLock.
+  std::atomic<unsigned> Remaining(SCCs.size());
+  std::mutex IdleLock;
+  std::condition_variable Wake;
+  int Queued = 0;
+
+  auto Push = [&](unsigned W, unsigned i) {
+    {
+      std::lock_guard<std::mutex> Guard(Workers[W].Lock);
+      Workers[W].Ready.push_back(i);
+    }
+    std::lock_guard<std::mutex> Guard(IdleLock);
+    Queued++;
+    Wake.notify_one();
+  };
+  auto Take = [&](unsigned W, unsigned& i) {
+    for (unsigned k = 0; k < Threads; ++k) {
+      Worker& Victim = Workers[(W + k) % Threads];
+      std::lock_guard<std::mutex> Guard(Victim.Lock);
+      if (Victim.Ready.empty())
+        continue;
+      if (k == 0) {
+        i = Victim.Ready.back();
+        Victim.Ready.pop_back();
+      } else {
+        i = Victim.Ready.front();
+        Victim.Ready.pop_front();
+      }
+      return true;
+    }
+    return false;
+  };
+  auto Work = [&](unsigned W) {
+    while (true) {
+      unsigned i;
+      if (Take(W, i)) {
+        {
+          std::lock_guard<std::mutex> Guard(IdleLock);
+          Queued--;
+        }
+        summarizeSCC(SCCs[i], Cache);
+        for (unsigned Caller : SCCs[i].Callers) {
+          if (Pending[Caller].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            Push(W, Caller);
+        }
+        // After the callers are queued, so that no worker stops early
+        if (Remaining.fetch_sub(1) == 1) {
+          std::lock_guard<std::mutex> Guard(IdleLock);
+          Wake.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> Guard(IdleLock);
+      Wake.wait(Guard, [&] { return Queued > 0 || Remaining == 0; });
+      if (Remaining == 0)
+        return;
+    }
+  };
+
+  // The leaves are dealt out round-robin
+  unsigned Next = 0;
+  for (unsigned i = 0; i < SCCs.size(); ++i) {
+    if (SCCs[i].NumCallees == 0)
+      Push(Next++ % Threads, i);
+  }
+  std::vector<std::thread> Pool;
+  for (unsigned W = 0; W < Threads; ++W)
+    Pool.emplace_back(Work, W);
+  for (std::thread& T : Pool)
+    T.join();
+}
+
+MD5::MD5Result FunctionSummaries::cacheKey(const SCCNode& SCC) const {
+  MD5 Hash;
+  Hash.update(("summary " + Twine(AnalysisCache::AnalysisVersion) + "\n").str());
+  for (Function* F : SCC.Members)
+    hashFunction(*F, Hash);
+
+  // The summaries of the members themselves are what the entry holds
+  DenseSet<const Function*> Members(SCC.Members.begin(), SCC.Members.end());
+  std::vector<uint32_t> Words;
+  for (Function* F : SCC.Members) {
+    for (auto& I : instructions(*F)) {
+      auto* Call = dyn_cast<CallBase>(&I);
+      const Function* Callee = Call ? Call->getCalledFunction() : nullptr;
+      if (const FunctionSummary* S = Members.count(Callee) ? nullptr : lookup(Callee))
+        S->serialize(Words);
+    }
+  }
+  Hash.update(ArrayRef<uint8_t>(reinterpret_cast<const uint8_t*>(Words.data()), 4 * Words.size()));
+
+  MD5::MD5Result Key;
+  Hash.final(Key);
+  return Key;
+}
+
+void FunctionSummaries::summarizeSCC(const SCCNode& SCC, AnalysisCache* Cache) {
+  using Clock = std::chrono::steady_clock;
+  MD5::MD5Result Key;
+  if (Cache) {
+    Key = cacheKey(SCC);
+    std::vector<uint32_t> Payload;
+    if (Cache->lookup(Key, Payload)) {
+      ArrayRef<uint32_t> Words = Payload;
+      bool Valid = true;
+      for (Function* F : SCC.Members) {
+        FunctionSummary& S = Summaries[Index.lookup(F)];
+        Valid = Valid && S.deserialize(Words) && S.Frees.size() == F->arg_size();
+      }
+      if (Valid && Words.empty())
+        return;
+    }
+  }
+  auto Start = Clock::now();
+
+  // From the bottom of the lattice, dropping what an entry rejected partway
+  // through left behind
+  for (Function* F : SCC.Members) {
+    FunctionSummary& S = Summaries[Index.lookup(F)];
+    S = FunctionSummary();
+    S.Frees.resize(F->arg_size());
+    S.Derefs.resize(F->arg_size());
+    S.Escapes.resize(F->arg_size());
+    S.ReturnsFresh = true;
+  }
+
+  bool Changed;
+  do {
+    Changed = false;
+    for (Function* F : SCC.Members) {
+      FunctionSummary S = summarize(*F);
+      FunctionSummary& Old = Summaries[Index.lookup(F)];
+      if (S != Old) {
+        Old = std::move(S);
+        Changed = true;
+      }
+    }
+  } while (Changed && SCC.Recursive);
+
+  if (Cache) {
+    std::vector<uint32_t> Payload;
+    for (Function* F : SCC.Members)
+      Summaries[Index.lookup(F)].serialize(Payload);
+    Cache->store(
+        Key, Payload, std::chrono::duration<double, std::milli>(Clock::now() - Start).count());
+  }
+}
+
+bool FunctionSummaries::sameSummaries(const FunctionSummaries& Other) const {
+  for (auto& I : Index) {
+    const FunctionSummary* S = Other.lookup(I.first);
+    if (!S || *S != Summaries[I.second])
+      return false;
+  }
+  return Index.size() == Other.Index.size();
+}
+
+unsigned FunctionSummaries::numRecursiveSCCs() const {
+  return std::count_if(
+      SCCs.begin(), SCCs.end(), [](const SCCNode& SCC) { return SCC.Recursive; });
+}
+
+FunctionSummary FunctionSummaries::summarize(Function& F, std::vector<SummaryEdge>* Edges) const {
+  // An origin is a parameter, a fresh allocation or anything else
+  const unsigned NumParams = F.arg_size();
+  const unsigned Fresh = NumParams;
+  const unsigned Unknown = NumParams + 1;
+
+  DenseMap<const Value*, BitVector> Origins;
+  // Origins of the values stored into each tracked stack slot
+  DenseMap<const AllocaInst*, BitVector> Slots;
+  for (auto& I : instructions(F)) {
+    if (auto* Alloca = dyn_cast<AllocaInst>(&I)) {
+      if (isTrackedSlot(Alloca))
+        Slots[Alloca].resize(NumParams + 2);
+    }
+  }
+
+  auto OriginsOf = [&](const Value* V) {
+    BitVector O(NumParams + 2);
+    if (auto* Arg = dyn_cast<Argument>(V)) {
+      O.set(Arg->getArgNo());
+    } else if (isa<ConstantPointerNull>(V) || isa<UndefValue>(V)) {
+      // Points nowhere
+    } else if (isa<Instruction>(V)) {
+      auto It = Origins.find(V);
+      if (It != Origins.end())
+        O = It->second;
+    } else {
+      O.set(Unknown);
+    }
+    return O;
+  };
+
+  auto CalleeSummary = [&](const CallBase* Call) -> const FunctionSummary* {
+    const Function* Callee = Call->getCalledFunction();
+    return Callee ? lookup(Callee) : nullptr;
+  };
+
+  // Origins only grow, so this ends after a few rounds
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto& I : instructions(F)) {
+      if (auto* Store = dyn_cast<StoreInst>(&I)) {
+        auto It = Slots.find(dyn_cast<AllocaInst>(Store->getPointerOperand()));
+        if (It != Slots.end() && Store->getValueOperand()->getType()->isPointerTy()) {
+          BitVector New = It->second;
+          New |= OriginsOf(Store->getValueOperand());
+          if (New != It->second) {
+            It->second = std::move(New);
+            Changed = true;
+          }
+        }
+        continue;
+      }
+
+      if (!I.getType()->isPointerTy())
+        continue;
+
+      BitVector O(NumParams + 2);
+      if (auto* Load = dyn_cast<LoadInst>(&I)) {
+        auto It = Slots.find(dyn_cast<AllocaInst>(Load->getPointerOperand()));
+        if (It != Slots.end())
+          O = It->second;
+        else
+          O.set(Unknown);
+      } else if (auto* Cast = dyn_cast<CastInst>(&I)) {
+        O = OriginsOf(Cast->getOperand(0));
+      } else if (auto* GEP = dyn_cast<GetElementPtrInst>(&I)) {
+        O = OriginsOf(GEP->getPointerOperand());
+      } else if (auto* Phi = dyn_cast<PHINode>(&I)) {
+        for (Value* Incoming : Phi->incoming_values())
+          O |= OriginsOf(Incoming);
+      } else if (auto* Select = dyn_cast<SelectInst>(&I)) {
+        O = OriginsOf(Select->getTrueValue());
+        O |= OriginsOf(Select->getFalseValue());
+      } else if (auto* Call = dyn_cast<CallBase>(&I)) {
+        const Function* Callee = Call->getCalledFunction();
+        const FunctionSummary* S = CalleeSummary(Call);
+        if ((Callee && isAllocation(Callee->getName())) || (S && S->ReturnsFresh))
+          O.set(Fresh);
+        else
+          O.set(Unknown);
+      } else {
+        // Stack slots and anything the summary does not follow
+        O.set(Unknown);
+      }
+
+      BitVector& Old = Origins[&I];
+      if (Old.empty())
+        Old.resize(NumParams + 2);
+      BitVector New = Old;
+      New |= O;
+      if (New != Old) {
+        Old = std::move(New);
+        Changed = true;
+      }
+    }
+  }
+
+  FunctionSummary Summary;
+  Summary.Frees.resize(NumParams);
+  Summary.Derefs.resize(NumParams);
+  Summary.Escapes.resize(NumParams);
+  Summary.ReturnsFresh = F.getReturnType()->isPointerTy();
+  bool ReturnsAllocation = false;
+  // Whether the function may free memory it allocated, possibly what it returns
+  bool FreesAllocation = false;
+  std::set<SummaryEdge> CallEdges;
+
+  for (auto& I : instructions(F)) {
+    if (auto* Load = dyn_cast<LoadInst>(&I)) {
+      addParams(Summary.Derefs, OriginsOf(Load->getPointerOperand()));
+    } else if (auto* Store = dyn_cast<StoreInst>(&I)) {
+      Value* Ptr = Store->getPointerOperand();
+      addParams(Summary.Derefs, OriginsOf(Ptr));
+      if (isa<GlobalVariable>(getUnderlyingObject(Ptr)))
+        addParams(Summary.Escapes, OriginsOf(Store->getValueOperand()));
+    } else if (auto* Call = dyn_cast<CallBase>(&I)) {
+      const Function* Callee = Call->getCalledFunction();
+      if (Callee && Callee->getName().equals("free") && Call->arg_size() >= 1) {
+        BitVector O = OriginsOf(Call->getArgOperand(0));
+        addParams(Summary.Frees, O);
+        FreesAllocation |= O.test(Fresh);
+        continue;
+      }
+      if (Edges && Callee && !Callee->isIntrinsic() && !isAllocation(Callee->getName())) {
+        // Facts of the callee that are only known once modules are linked
+        for (unsigned j = 0; j < Call->arg_size(); ++j) {
+          if (!Call->getArgOperand(j)->getType()->isPointerTy())
+            continue;
+          for (unsigned k : OriginsOf(Call->getArgOperand(j)).set_bits()) {
+            if (k <= Fresh)
+              CallEdges.insert({k, indexName(*Callee), j});
+          }
+        }
+      }
+      const FunctionSummary* S = CalleeSummary(Call);
+      if (!S) {
+        // A declaration or indirect call may dereference any of its arguments
+        for (unsigned j = 0; j < Call->arg_size(); ++j) {
+          if (Call->getArgOperand(j)->getType()->isPointerTy())
+            addParams(Summary.Derefs, OriginsOf(Call->getArgOperand(j)));
+        }
+        continue;
+      }
+      unsigned NumArgs = std::min<unsigned>(Call->arg_size(), S->Frees.size());
+      for (unsigned j = 0; j < NumArgs; ++j) {
+        BitVector O = OriginsOf(Call->getArgOperand(j));
+        if (S->Frees.test(j)) {
+          addParams(Summary.Frees, O);
+          FreesAllocation |= O.test(Fresh);
+        }
+        if (S->Derefs.test(j))
+          addParams(Summary.Derefs, O);
+        if (S->Escapes.test(j))
+          addParams(Summary.Escapes, O);
+      }
+    } else if (auto* Ret = dyn_cast<ReturnInst>(&I)) {
+      Value* V = Ret->getReturnValue();
+      if (!V || !V->getType()->isPointerTy())
+        continue;
+      BitVector O = OriginsOf(V);
+      ReturnsAllocation |= O.test(Fresh);
+      O.reset(Fresh);
+      if (O.any())
+        Summary.ReturnsFresh = false;
+    }
+  }
+  Summary.ReturnsFresh &= ReturnsAllocation && !FreesAllocation;
+  // Whoever reads an escaped parameter from its global may dereference it
+  Summary.Derefs |= Summary.Escapes;
+  if (Edges)
+    Edges->insert(Edges->end(), CallEdges.begin(), CallEdges.end());
+
+  return Summary;
+}
+
+bool FunctionSummaries::invalidate(
+    Module& M, const PreservedAnalyses& PA, ModuleAnalysisManager::Invalidator& Inv) {
+  auto PAC = PA.getChecker<FunctionSummaryAnalysis>();
+  return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Module>>());
+}
+
+FunctionSummaryAnalysis::Result FunctionSummaryAnalysis::run(
+    Module& M, ModuleAnalysisManager& AM) {
+  // Summarized by the first pass that needs them, with its thread count
+  return FunctionSummaries(M);
+}
+
+PreservedAnalyses FunctionSummaryPrinter::run(Module& M, ModuleAnalysisManager& AM) {
+  using Clock = std::chrono::steady_clock;
+  FunctionSummaries& Summaries = AM.getResult<FunctionSummaryAnalysis>(M);
+  std::unique_ptr<AnalysisCache> Cache;
+  if (!Options.CacheDir.empty())
+    Cache = std::make_unique<AnalysisCache>(Options.CacheDir);
+  if (!Options.IndexFile.empty())
+    importSummaryIndex(Summaries, Options.IndexFile);
+  auto Start = Clock::now();
+  Summaries.compute(Options.Threads, false, Cache.get());
+  double Ms = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+
+  size_t Functions = 0;
+  for (auto& F : M) {
+    const FunctionSummary* S = F.isDeclaration() ? nullptr : Summaries.lookup(&F);
+    if (S) {
+      outs() << F.getName() << ": ";
+      S->print(outs());
+      outs() << "\n";
+      Functions++;
+    }
+  }
+  outs() << "Summarized " << Summaries.numSCCs() << " call graph components, "
+         << Summaries.numRecursiveSCCs() << " recursive\n";
+  if (Cache)
+    Cache->print(outs(), "Summary");
+  if (Options.Verify) {
+    // Outside the timing, so that the time is the parallel or cached run alone
+    if (!Summaries.matchesSequential())
+      report_fatal_error("function summaries differ from the uncached sequential ones");
+    outs() << "Summaries verified against an uncached sequential run\n";
+  }
+  if (!Options.EmitFile.empty()) {
+    SummaryIndex Exports;
+    Summaries.exportTo(Exports);
+    std::string Error;
+    if (!Exports.write(Options.EmitFile, Error))
+      report_fatal_error(Twine("cannot write summary index ") + Options.EmitFile + ": " + Error);
+    outs() << "Wrote " << Exports.size() << " summaries to " << Options.EmitFile << "\n";
+  }
+  outs() << "Summary total: " << Functions << " functions, " << format("%.3f", Ms) << " ms\n";
+  return PreservedAnalyses::all();
+}
+
+}  // namespace dataflow
@@ -0,0 +1,601 @@
+#include "ModulePointerAnalysis.h"
+
+#include "Utils.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include <algorithm>
+
+namespace dataflow {
+
+ModulePointerAnalysis::NodeID ModulePointerAnalysis::newNode() {
+  NodeID N = PointsTo.size();
+  PointsTo.emplace_back();
+  Propagated.emplace_back();
+  Copies.emplace_back();
+  Loads.emplace_back();
+  Stores.emplace_back();
+  InWorkList.push_back(false);
+  Rep.push_back(N);
+  return N;
+}
+
+ModulePointerAnalysis::NodeID ModulePointerAnalysis::node(const Value* V) {
+  if (isa<Constant>(V)) {
+    V = stripConstant(V);
+    // Null, undef and integer constants point nowhere
+    if (!isa<GlobalValue>(V))
+      return NoNode;
+  }
+
+  auto It = ValueNodes.find(V);
+  if (It != ValueNodes.end())
+    return Rep[It->second];
+
+  NodeID N = newNode();
+  ValueNodes[V] = N;
+  // A global names its own storage
+  if (isa<GlobalValue>(V))
+    addressOf(N, site(V));
+  return N;
+}
+
+ModulePointerAnalysis::SiteID ModulePointerAnalysis::site(const Value* V) {
+  SiteID Site = SiteValues.size();
+  SiteValues.push_back(V);
+  ObjectNodes.push_back(newNode());
+  if (auto* F = dyn_cast<Function>(V))
+    FunctionSites[Site] = F;
+  return Site;
+}
+
+void ModulePointerAnalysis::addressOf(NodeID N, SiteID Site) {
+  if (!Reduced)
+    Addresses.push_back({N, Site});
+  PointsTo[N].set(Site);
+  push(N);
+}
+
+void ModulePointerAnalysis::addCopy(NodeID Src, NodeID Dst) {
+  if (Src == NoNode || Dst == NoNode || Src == Dst || !Edges.insert({Src, Dst}).second)
+    return;
+
+  Copies[Src].push_back(Dst);
+  // Only later differences are pushed along existing edges, so a new edge
+  // starts with everything the source has.
+  if (PointsTo[Dst] |= PointsTo[Src])
+    push(Dst);
+}
+
+void ModulePointerAnalysis::push(NodeID N) {
+  if (!InWorkList[N]) {
+    InWorkList[N] = true;
+    WorkList.push_back(N);
+  }
+}
+
+void ModulePointerAnalysis::collectGlobal(GlobalVariable& G) {
+  NodeID Object = ObjectNodes[*PointsTo[node(&G)].begin()];
+  if (!G.hasInitializer())
+    return;
+
+  // Every pointer in the initializer, wherever it sits in an aggregate
+  std::vector<const Constant*> WorkList = {G.getInitializer()};
+  while (!WorkList.empty()) {
+    const Constant* C = WorkList.back();
+    WorkList.pop_back();
+    if (C->getType()->isPointerTy()) {
+      addCopy(node(C), Object);
+    } else if (isa<ConstantAggregate>(C)) {
+      for (const Use& Op : C->operands())
+        WorkList.push_back(cast<Constant>(Op));
+    }
+  }
+}
+
+void ModulePointerAnalysis::collectFunction(Function& F) {
+  // Callers outside the module (or through pointers that escape it) may pass
+  // anything, so such arguments also point to an opaque object of their own.
+  bool UnknownCallers = !F.hasLocalLinkage() || F.hasAddressTaken();
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy()) {
+      NodeID N = node(&Arg);
+      if (UnknownCallers)
+        addressOf(N, site(&Arg));
+    }
+  }
+
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    collectInstruction(&*Iter);
+  }
+}
+
+void ModulePointerAnalysis::collectInstruction(Instruction* Inst) {
+  if (auto* Alloca = dyn_cast<AllocaInst>(Inst)) {
+    addressOf(node(Alloca), site(Alloca));
+
+  } else if (auto* Store = dyn_cast<StoreInst>(Inst)) {
+    if (!Store->getValueOperand()->getType()->isPointerTy())
+      return;
+    NodeID Ptr = node(Store->getPointerOperand());
+    NodeID Val = node(Store->getValueOperand());
+    if (Ptr != NoNode && Val != NoNode)
+      Stores[Ptr].push_back(Val);
+
+  } else if (auto* Load = dyn_cast<LoadInst>(Inst)) {
+    if (!Load->getType()->isPointerTy())
+      return;
+    NodeID Ptr = node(Load->getPointerOperand());
+    NodeID Dst = node(Load);
+    if (Ptr != NoNode)
+      Loads[Ptr].push_back(Dst);
+
+  } else if (auto* Call = dyn_cast<CallBase>(Inst)) {
+    auto* Callee = dyn_cast<Function>(stripConstant(Call->getCalledOperand()));
+    if (Callee && Callee->isDeclaration()) {
+      // External code such as malloc: every call returns a fresh object
+      if (Call->getType()->isPointerTy())
+        addressOf(node(Call), site(Call));
+    } else if (Callee) {
+      connectCall(Call, Callee);
+    } else {
+      NodeID Target = node(Call->getCalledOperand());
+      if (Target != NoNode)
+        IndirectCalls[Target].push_back(Call);
+    }
+
+  } else if (auto* Ret = dyn_cast<ReturnInst>(Inst)) {
+    Value* Val = Ret->getReturnValue();
+    if (Val && Val->getType()->isPointerTy()) {
+      NodeID N = node(Val);
+      if (N != NoNode)
+        Returns[Ret->getFunction()].push_back(N);
+    }
+
+  } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
+    if (Cast->getType()->isPointerTy() && Cast->getOperand(0)->getType()->isPointerTy())
+      addCopy(node(Cast->getOperand(0)), node(Cast));
+
+  } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
+    addCopy(node(GEP->getPointerOperand()), node(GEP));
+
+  } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
+    if (!Phi->getType()->isPointerTy())
+      return;
+    NodeID N = node(Phi);
+    for (Value* Incoming : Phi->incoming_values())
+      addCopy(node(Incoming), N);
+
+  } else if (auto* Select = dyn_cast<SelectInst>(Inst)) {
+    if (!Select->getType()->isPointerTy())
+      return;
+    NodeID N = node(Select);
+    addCopy(node(Select->getTrueValue()), N);
+    addCopy(node(Select->getFalseValue()), N);
+  }
+}
+
+void ModulePointerAnalysis::connectCall(const CallBase* Call, const Function* Callee) {
+  if (Callee->isDeclaration() || !CallEdges.insert({Call, Callee}).second)
+    return;
+
+  unsigned N = std::min<unsigned>(Call->arg_size(), Callee->arg_size());
+  for (unsigned i = 0; i < N; ++i) {
+    const Argument* Formal = Callee->getArg(i);
+    if (Formal->getType()->isPointerTy())
+      addCopy(node(Call->getArgOperand(i)), node(Formal));
+  }
+
+  if (Call->getType()->isPointerTy()) {
+    NodeID Result = node(Call);
+    // Returns of Callee are all collected before solving starts
+    for (NodeID Ret : Returns.lookup(Callee))
+      addCopy(Ret, Result);
+  }
+}
+
+void ModulePointerAnalysis::addCalls(NodeID N, SiteID Site) {
+  // Connecting a call may create nodes and sites, so no iterator into
+  // FunctionSites is kept across it
+  const Function* Callee = FunctionSites.lookup(Site);
+  auto Calls = IndirectCalls.find(N);
+  if (Callee && Calls != IndirectCalls.end()) {
+    for (const CallBase* Call : Calls->second)
+      connectCall(Call, Callee);
+  }
+}
+
+void ModulePointerAnalysis::propagate() {
+  while (!WorkList.empty()) {
+    NodeID N = WorkList.back();
+    WorkList.pop_back();
+    InWorkList[N] = false;
+
+    SiteSet Delta = PointsTo[N];
+    Delta.intersectWithComplement(Propagated[N]);
+    if (Delta.empty())
+      continue;
+    Propagated[N] |= Delta;
+
+    for (SiteID Site : Delta) {
+      NodeID Object = ObjectNodes[Site];
+      for (NodeID Dst : Loads[N])
+        addCopy(Object, Dst);
+      for (NodeID Src : Stores[N])
+        addCopy(Src, Object);
+      addCalls(N, Site);
+    }
+
+    // Edges may be added to N while walking them
+    for (unsigned i = 0; i < Copies[N].size(); ++i) {
+      NodeID Dst = Copies[N][i];
+      if (PointsTo[Dst] |= Delta)
+        push(Dst);
+    }
+  }
+}
+
+/**
+ * @brief Strongly connected components of the copy edges, in topological
+ * order (Tarjan's algorithm without recursion).
+ */
+static std::vector<std::vector<unsigned>> copyComponents(
+    const std::vector<SmallVector<unsigned, 2>>& Copies) {
+  size_t Size = Copies.size();
+  std::vector<unsigned> Index(Size, ~0u), Low(Size);
+  std::vector<bool> OnStack(Size);
+  std::vector<unsigned> Stack;
+  std::vector<std::vector<unsigned>> Components;
+  // Node and next edge to visit
+  std::vector<std::pair<unsigned, unsigned>> Path;
+  unsigned Next = 0;
+
+  for (unsigned Root = 0; Root < Size; ++Root) {
+    if (Index[Root] != ~0u)
+      continue;
+    Path.push_back({Root, 0});
+    Index[Root] = Low[Root] = Next++;
+    Stack.push_back(Root);
+    OnStack[Root] = true;
+
+    while (!Path.empty()) {
+      unsigned N = Path.back().first;
+      unsigned& Edge = Path.back().second;
+      if (Edge < Copies[N].size()) {
+        unsigned Dst = Copies[N][Edge++];
+        if (Index[Dst] == ~0u) {
+          Index[Dst] = Low[Dst] = Next++;
+          Stack.push_back(Dst);
+          OnStack[Dst] = true;
+          Path.push_back({Dst, 0});
+        } else if (OnStack[Dst]) {
+          Low[N] = std::min(Low[N], Index[Dst]);
+        }
+        continue;
+      }
+
+      Path.pop_back();
+      if (!Path.empty())
+        Low[Path.back().first] = std::min(Low[Path.back().first], Low[N]);
+      if (Low[N] == Index[N]) {
+        Components.emplace_back();
+        unsigned Member;
+        do {
+          Member = Stack.back();
+          Stack.pop_back();
+          OnStack[Member] = false;
+          Components.back().push_back(Member);
+        } while (Member != N);
+      }
+    }
+  }
+
+  // Tarjan completes a component after everything it reaches
+  std::reverse(Components.begin(), Components.end());
+  return Components;
+}
+
+void ModulePointerAnalysis::reduce() {
+  if (Reduced || Solved)
+    return;
+  Reduced = true;
+
+  // Nodes that may gain incoming edges while solving
+  std::vector<bool> Indirect(PointsTo.size());
+  for (NodeID Object : ObjectNodes)
+    Indirect[Object] = true;
+  for (auto& Dsts : Loads) {
+    for (NodeID Dst : Dsts)
+      Indirect[Dst] = true;
+  }
+  auto MarkValue = [&](const Value* V) {
+    auto It = ValueNodes.find(V);
+    if (It != ValueNodes.end())
+      Indirect[It->second] = true;
+  };
+  for (auto& I : IndirectCalls) {
+    for (const CallBase* Call : I.second)
+      MarkValue(Call);
+  }
+  for (auto& I : FunctionSites) {
+    for (const Argument& Arg : I.second->args())
+      MarkValue(&Arg);
+  }
+
+  size_t Size = PointsTo.size();
+  std::vector<SmallVector<NodeID, 2>> Preds(Size);
+  for (NodeID N = 0; N < Size; ++N) {
+    for (NodeID Dst : Copies[N])
+      Preds[Dst].push_back(N);
+  }
+  std::vector<SmallVector<SiteID, 1>> Sites(Size);
+  for (auto& A : Addresses)
+    Sites[A.first].push_back(A.second);
+  Addresses = {};
+
+  // Label 0 is the empty set. A node with a single incoming label shares it;
+  // equal sets of several labels are numbered alike.
+  std::vector<unsigned> Label(Size);
+  std::map<std::vector<unsigned>, unsigned> SetLabels;
+  DenseMap<SiteID, unsigned> SiteLabels;
+  unsigned NextLabel = 1;
+  std::vector<unsigned> In;
+  std::vector<unsigned> Component(Size);
+  std::vector<std::vector<NodeID>> Components = copyComponents(Copies);
+  for (unsigned C = 0; C < Components.size(); ++C) {
+    for (NodeID N : Components[C])
+      Component[N] = C;
+  }
+
+  for (unsigned C = 0; C < Components.size(); ++C) {
+    In.clear();
+    bool Fresh = false;
+    for (NodeID N : Components[C]) {
+      Fresh |= Indirect[N];
+      for (SiteID Site : Sites[N]) {
+        auto Inserted = SiteLabels.insert({Site, NextLabel});
+        NextLabel += Inserted.second;
+        In.push_back(Inserted.first->second);
+      }
+      for (NodeID Pred : Preds[N]) {
+        if (Component[Pred] != C && Label[Pred])
+          In.push_back(Label[Pred]);
+      }
+    }
+    std::sort(In.begin(), In.end());
+    In.erase(std::unique(In.begin(), In.end()), In.end());
+
+    unsigned L = 0;
+    if (Fresh) {
+      L = NextLabel++;
+    } else if (In.size() == 1) {
+      L = In[0];
+    } else if (!In.empty()) {
+      auto Inserted = SetLabels.insert({In, NextLabel});
+      NextLabel += Inserted.second;
+      L = Inserted.first->second;
+    }
+    for (NodeID N : Components[C])
+      Label[N] = L;
+  }
+
+  // The first node of a label stands for all of them
+  std::vector<NodeID> First(NextLabel, NoNode);
+  for (NodeID N = 0; N < Size; ++N) {
+    if (First[Label[N]] == NoNode)
+      First[Label[N]] = N;
+    Rep[N] = First[Label[N]];
+  }
+
+  for (NodeID N = 0; N < Size; ++N) {
+    NodeID R = Rep[N];
+    if (R == N)
+      continue;
+    Merged++;
+    PointsTo[R] |= PointsTo[N];
+    PointsTo[N].clear();
+    Copies[R].append(Copies[N].begin(), Copies[N].end());
+    Loads[R].append(Loads[N].begin(), Loads[N].end());
+    Stores[R].append(Stores[N].begin(), Stores[N].end());
+    Copies[N].clear();
+    Loads[N].clear();
+    Stores[N].clear();
+  }
+
+  auto Remap = [&](SmallVectorImpl<NodeID>& Nodes) {
+    for (NodeID& N : Nodes)
+      N = Rep[N];
+    std::sort(Nodes.begin(), Nodes.end());
+    Nodes.erase(std::unique(Nodes.begin(), Nodes.end()), Nodes.end());
+  };
+  Edges.clear();
+  for (NodeID N = 0; N < Size; ++N) {
+    Remap(Copies[N]);
+    Copies[N].erase(std::remove(Copies[N].begin(), Copies[N].end(), N), Copies[N].end());
+    for (NodeID Dst : Copies[N])
+      Edges.insert({N, Dst});
+    Remap(Loads[N]);
+    Remap(Stores[N]);
+  }
+  for (NodeID& Object : ObjectNodes)
+    Object = Rep[Object];
+  for (auto& I : Returns)
+    Remap(I.second);
+  DenseMap<NodeID, SmallVector<const CallBase*, 1>> Calls;
+  for (auto& I : IndirectCalls) {
+    auto& To = Calls[Rep[I.first]];
+    To.append(I.second.begin(), I.second.end());
+  }
+  IndirectCalls = std::move(Calls);
+
+  WorkList.clear();
+  InWorkList.assign(Size, false);
+  for (NodeID N = 0; N < Size; ++N) {
+    if (!PointsTo[N].empty())
+      push(N);
+  }
+}
+
+void ModulePointerAnalysis::solve(bool Verify, bool Reduce) {
+  if (Solved)
+    return;
+  if (Reduce)
+    reduce();
+  Solved = true;
+  propagate();
+
+  if (Verify && Reduced) {
+    ModulePointerAnalysis Unreduced(M);
+    Unreduced.solve(false, false);
+    if (!sameSolution(Unreduced))
+      report_fatal_error("points-to solution differs from the unreduced one");
+  }
+}
+
+bool ModulePointerAnalysis::sameSolution(const ModulePointerAnalysis& Other) const {
+  if (ValueNodes.size() != Other.ValueNodes.size())
+    return false;
+
+  // Sites as the values they were created for
+  auto Values = [](const ModulePointerAnalysis& Solution, NodeID N) {
+    std::vector<const Value*> Result;
+    for (SiteID Site : Solution.PointsTo[Solution.Rep[N]])
+      Result.push_back(Solution.SiteValues[Site]);
+    std::sort(Result.begin(), Result.end());
+    return Result;
+  };
+  for (auto& I : ValueNodes) {
+    auto It = Other.ValueNodes.find(I.first);
+    if (It == Other.ValueNodes.end() || Values(*this, I.second) != Values(Other, It->second))
+      return false;
+  }
+  return true;
+}
+
+ModulePointerAnalysis::ModulePointerAnalysis(Module& M) : M(M) {
+  for (auto& G : M.globals()) {
+    collectGlobal(G);
+  }
+
+  // Returns first, so that connecting a call sees all values its callee
+  // can return.
+  for (auto& F : M) {
+    for (auto& BB : F) {
+      if (auto* Ret = dyn_cast<ReturnInst>(BB.getTerminator()))
+        collectInstruction(Ret);
+    }
+  }
+  for (auto& F : M) {
+    if (!F.isDeclaration())
+      collectFunction(F);
+  }
+}
+
+const SiteSet& ModulePointerAnalysis::pointsTo(const Value* V) const {
+  static const SiteSet Empty;
+  if (isa<Constant>(V))
+    V = stripConstant(V);
+  assert(Solved && "points-to queried before solving");
+  auto It = ValueNodes.find(V);
+  return It == ValueNodes.end() ? Empty : PointsTo[Rep[It->second]];
+}
+
+ModulePointsToView& ModulePointerAnalysis::function(Function& F) {
+  std::unique_ptr<ModulePointsToView>& View = Views[&F];
+  if (!View)
+    View = std::make_unique<ModulePointsToView>(*this, F);
+  return *View;
+}
+
+const Value* ModulePointerAnalysis::siteValue(SiteID Site) const {
+  return SiteValues[Site];
+}
+
+size_t ModulePointerAnalysis::numNodes() const {
+  return PointsTo.size();
+}
+
+size_t ModulePointerAnalysis::numSites() const {
+  return SiteValues.size();
+}
+
+size_t ModulePointerAnalysis::numCallEdges() const {
+  return CallEdges.size();
+}
+
+size_t ModulePointerAnalysis::numMerged() const {
+  return Merged;
+}
+
+bool ModulePointerAnalysis::invalidate(
+    Module& M, const PreservedAnalyses& PA, ModuleAnalysisManager::Invalidator& Inv) {
+  auto PAC = PA.getChecker<ModulePointsToAnalysis>();
+  return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Module>>());
+}
+
+//===----------------------------------------------------------------------===//
+// Per-function view
+//===----------------------------------------------------------------------===//
+
+ModulePointsToView::ModulePointsToView(const ModulePointerAnalysis& Solution, Function& F) {
+  build(Solution, F);
+}
+
+ModulePointsToView::ModulePointsToView(std::unique_ptr<ModulePointerAnalysis> Owned, Function& F)
+    : Owned(std::move(Owned)) {
+  build(*this->Owned, F);
+}
+
+void ModulePointsToView::build(const ModulePointerAnalysis& Solution, Function& F) {
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy())
+      PointsTo[variable(&Arg)] |= Solution.pointsTo(&Arg);
+  }
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    if (Iter->getType()->isPointerTy())
+      PointsTo[variable(&*Iter)] |= Solution.pointsTo(&*Iter);
+  }
+
+  for (auto& I : PointsTo) {
+    for (unsigned Site : I.second)
+      PointedBy[Site].push_back(&I.first);
+  }
+}
+
+bool ModulePointsToView::alias(std::string& Ptr1, std::string& Ptr2) const {
+  auto It1 = PointsTo.find(Ptr1);
+  auto It2 = PointsTo.find(Ptr2);
+  if (It1 == PointsTo.end() || It2 == PointsTo.end())
+    return false;
+  return It1->second.intersects(It2->second);
+}
+
+std::vector<std::string> ModulePointsToView::aliases(const std::string& Ptr) const {
+  auto It = PointsTo.find(Ptr);
+  if (It == PointsTo.end())
+    return {};
+
+  std::vector<const std::string*> Found;
+  for (unsigned Site : It->second) {
+    for (const std::string* Name : PointedBy.at(Site)) {
+      if (Name != &It->first)
+        Found.push_back(Name);
+    }
+  }
+  std::sort(Found.begin(), Found.end());
+  Found.erase(std::unique(Found.begin(), Found.end()), Found.end());
+
+  std::vector<std::string> Result;
+  for (const std::string* Name : Found)
+    Result.push_back(*Name);
+  return Result;
+}
+
+ModulePointsToAnalysis::Result ModulePointsToAnalysis::run(Module& M, ModuleAnalysisManager& AM) {
+  return ModulePointerAnalysis(M);
+}
+
+}  // namespace dataflow
@@ -0,0 +1,260 @@
+#include "NullDataflowAnalysis.h"
+
+#include "Utils.h"
+#include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+
+#include <set>
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Flow-Sensitive Nullness Analysis Implementation
+//===----------------------------------------------------------------------===//
+
+/**
+ * @brief Join of two null states, Unknown being the bottom.
+ */
+static Domain::NullState joinNull(Domain::NullState N1, Domain::NullState N2) {
+  if (N1 == Domain::Unknown)
+    return N2;
+  if (N2 == Domain::Unknown || N1 == N2)
+    return N1;
+  return Domain::MaybeNull;
+}
+
+void NullDataflowAnalysis::collectCells(Function& F, const PointerAnalysis& PA) {
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy())
+      ValueCells[&Arg] = NumCells++;
+  }
+
+  // Only a slot allocated once per call stands for a single object, and
+  // only one of a scalar type is written whole by a store. Cells are per
+  // object, so a field of a struct shares the cell of its siblings.
+  std::set<std::string> Slots;
+  for (auto& I : F.getEntryBlock()) {
+    auto* Alloca = dyn_cast<AllocaInst>(&I);
+    if (Alloca && !Alloca->isArrayAllocation() && !Alloca->getAllocatedType()->isAggregateType())
+      Slots.insert(address(Alloca));
+  }
+
+  for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+    Instruction* Inst = &*Iter;
+    if (Inst->getType()->isPointerTy())
+      ValueCells[Inst] = NumCells++;
+
+    Value* Ptr = nullptr;
+    if (auto* Load = dyn_cast<LoadInst>(Inst))
+      Ptr = Load->getPointerOperand();
+    else if (auto* Store = dyn_cast<StoreInst>(Inst))
+      Ptr = Store->getPointerOperand();
+    if (!Ptr)
+      continue;
+
+    std::vector<std::string> Locs = PA.pointees(Ptr);
+    std::vector<unsigned>& Cells = Targets[Inst];
+    for (const std::string& Loc : Locs) {
+      auto It = LocationCells.emplace(Loc, NumCells);
+      NumCells += It.second;
+      Cells.push_back(It.first->second);
+    }
+    // Through the slot itself, not a GEP or cast into it
+    StrongUpdate[Inst] =
+        isa<AllocaInst>(Ptr) && Locs.size() == 1 && Slots.count(Locs[0]);
+  }
+}
+
+Domain::NullState NullDataflowAnalysis::evalNull(const NullMemory& Mem, const Value* V) const {
+  if (isa<ConstantPointerNull>(V))
+    return Domain::Null;
+  if (isa<GlobalValue>(V))
+    return Domain::NotNull;
+  auto It = ValueCells.find(V);
+  return It == ValueCells.end() ? Domain::Unknown : Mem[It->second];
+}
+
+void NullDataflowAnalysis::transfer(Instruction* Inst, NullMemory& Mem) {
+  if (auto* Store = dyn_cast<StoreInst>(Inst)) {
+    Value* ValueOp = Store->getValueOperand();
+    if (!ValueOp->getType()->isPointerTy())
+      return;
+
+    // Overwrite the slot, or add to what the locations may hold
+    Domain::NullState N = evalNull(Mem, ValueOp);
+    bool Strong = StrongUpdate.lookup(Store);
+    for (unsigned Cell : Targets[Store])
+      Mem[Cell] = Strong ? N : joinNull(Mem[Cell], N);
+    return;
+  }
+
+  if (!Inst->getType()->isPointerTy())
+    return;
+
+  Domain::NullState N = Domain::Unknown;
+  if (isa<AllocaInst>(Inst) || isa<CallInst>(Inst)) {
+    // A fresh object, as in PointerAnalysis, where every call is a site
+    N = Domain::NotNull;
+  } else if (isa<LoadInst>(Inst)) {
+    for (unsigned Cell : Targets[Inst])
+      N = joinNull(N, Mem[Cell]);
+  } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
+    if (Cast->getOperand(0)->getType()->isPointerTy())
+      N = evalNull(Mem, Cast->getOperand(0));
+  } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
+    N = evalNull(Mem, GEP->getPointerOperand());
+  } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
+    for (Value* Incoming : Phi->incoming_values())
+      N = joinNull(N, evalNull(Mem, Incoming));
+  } else if (auto* Select = dyn_cast<SelectInst>(Inst)) {
+    N = joinNull(evalNull(Mem, Select->getTrueValue()), evalNull(Mem, Select->getFalseValue()));
+  }
+  Mem[ValueCells[Inst]] = N;
+}
+
+void NullDataflowAnalysis::refineEdge(BasicBlock* Pred, BasicBlock* Succ, NullMemory& Mem) {
+  auto* BI = dyn_cast<BranchInst>(Pred->getTerminator());
+  if (!BI || !BI->isConditional() || BI->getSuccessor(0) == BI->getSuccessor(1))
+    return;
+
+  auto* Cmp = dyn_cast<ICmpInst>(BI->getCondition());
+  if (!Cmp || !Cmp->isEquality())
+    return;
+
+  // Check for ptr != null or ptr == null patterns
+  Value* PtrOp = nullptr;
+  if (isa<ConstantPointerNull>(Cmp->getOperand(1)))
+    PtrOp = Cmp->getOperand(0);
+  else if (isa<ConstantPointerNull>(Cmp->getOperand(0)))
+    PtrOp = Cmp->getOperand(1);
+  auto It = PtrOp ? ValueCells.find(PtrOp) : ValueCells.end();
+  if (It == ValueCells.end())
+    return;
+
+  BasicBlock* NotNullBB = BI->getSuccessor(Cmp->getPredicate() == ICmpInst::ICMP_NE ? 0 : 1);
+  Domain::NullState N = Succ == NotNullBB ? Domain::NotNull : Domain::Null;
+  Mem[It->second] = N;
+
+  // The slot the pointer was loaded from holds the same value
+  if (auto* Load = dyn_cast<LoadInst>(PtrOp)) {
+    if (StrongUpdate.lookup(Load))
+      Mem[Targets[Load][0]] = N;
+  }
+}
+
+void NullDataflowAnalysis::flowIn(BasicBlock* BB, NullMemory& InMem) {
+  InMem.assign(NumCells, Domain::Unknown);
+
+  for (BasicBlock* Pred : predecessors(BB)) {
+    NullMemory Edge = OutMap[Pred];
+    if (Edge.empty())
+      continue;  // Not reached yet
+    refineEdge(Pred, BB, Edge);
+    for (unsigned Cell = 0; Cell < NumCells; ++Cell)
+      InMem[Cell] = joinNull(InMem[Cell], Edge[Cell]);
+  }
+}
+
+void NullDataflowAnalysis::flowOut(
+    BasicBlock* BB, NullMemory& Post, SetVector<BasicBlock*>& WorkSet) {
+  NullMemory& OutOld = OutMap[BB];
+  if (OutOld == Post)
+    return;
+
+  OutOld.swap(Post);
+  for (BasicBlock* Succ : successors(BB))
+    WorkSet.insert(Succ);
+}
+
+void NullDataflowAnalysis::doAnalysis(Function& F) {
+  // Popped from the back, so reverse post-order comes out first
+  SetVector<BasicBlock*> WorkSet;
+  for (BasicBlock* BB : post_order(&F))
+    WorkSet.insert(BB);
+
+  while (!WorkSet.empty()) {
+    BasicBlock* BB = WorkSet.pop_back_val();
+
+    NullMemory& In = InMap[BB];
+    flowIn(BB, In);
+
+    NullMemory OutCur = In;
+    for (auto& Inst : *BB)
+      transfer(&Inst, OutCur);
+
+    flowOut(BB, OutCur, WorkSet);
+  }
+}
+
+bool NullDataflowAnalysis::check(Instruction* Inst, const NullMemory& Mem) const {
+  Value* Ptr = nullptr;
+  if (auto* Load = dyn_cast<LoadInst>(Inst))
+    Ptr = Load->getPointerOperand();
+  else if (auto* Store = dyn_cast<StoreInst>(Inst))
+    Ptr = Store->getPointerOperand();
+  else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst))
+    // GEP itself is a pointer dereference (even though it doesn't access
+    // memory), as in PointerAnalysis
+    Ptr = GEP->getPointerOperand();
+  if (!Ptr)
+    return false;
+
+  Domain::NullState N = evalNull(Mem, Ptr);
+  return N == Domain::Null || N == Domain::MaybeNull;
+}
+
+PreservedAnalyses NullDataflowAnalysis::run(Module& M, ModuleAnalysisManager& AM) {
+  outs() << "Running Null pointer dereference: Flow-Sensitive Dataflow Analysis on module "
+         << M.getName() << "\n";
+  auto& FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+  for (auto& F : M) {
+    if (F.isDeclaration()) {
+      continue;
+    }
+
+    outs() << "Running " << getAnalysisName() << " on " << F.getName() << "\n";
+
+    ErrorInsts.clear();
+    InMap.clear();
+    OutMap.clear();
+    ValueCells.clear();
+    LocationCells.clear();
+    NumCells = 0;
+    Targets.clear();
+    StrongUpdate.clear();
+
+    // Flow-insensitive points-to, shared with NullPointerAnalysis
+    collectCells(F, FAM.getResult<NullPointsToAnalysis>(F));
+    doAnalysis(F);
+
+    // Replay each reached block from its In memory to check every instruction
+    // against the memory just before it
+    for (auto& BB : F) {
+      auto It = InMap.find(&BB);
+      if (It == InMap.end())
+        continue;
+      NullMemory Mem = It->second;
+      for (auto& Inst : BB) {
+        if (check(&Inst, Mem))
+          ErrorInsts.insert(&Inst);
+        transfer(&Inst, Mem);
+      }
+    }
+
+    for (auto Inst : ErrorInsts) {
+      const char* Kind = isa<LoadInst>(Inst)    ? "load"
+                         : isa<StoreInst>(Inst) ? "store"
+                                                : "getelementptr";
+      errs() << "Possible null dereference (" << Kind << ") in " << F.getName()
+             << " at: " << *Inst << "\n";
+    }
+  }
+
+  return PreservedAnalyses::all();
+}
+
+}  // namespace dataflow
@@ -1,8 +1,10 @@
 #include "Domain.h"
-#include <queue>
+#include <algorithm>
+#include "NullDataflowAnalysis.h"
 #include "PointerAnalysis.h"
 #include "Utils.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Passes/PassBuilder.h"
@@ -12,14 +14,11 @@ namespace dataflow {
 
 void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
     if (AllocaInst* Alloca = dyn_cast<AllocaInst>(Inst)) {
-        PointsToSet& S = PointsTo[variable(Alloca)];
-        S.insert(address(Alloca));
+        std::string Var = variable(Alloca);
+        PointsToSet& S = PointsTo[Var];
+        S.insert(site(address(Alloca)));
         // update null state for the allocated variable
-        auto NewState = computeNullState(variable(Alloca), PointsTo);
-        if (NullStates[variable(Alloca)] != NewState) {
-            NullStates[variable(Alloca)] = NewState;
-            NullChanged = true;
-        }
+        updateNullState(Var, S);
 
     } else if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
         Value* Pointer = Store->getPointerOperand();
@@ -31,83 +30,60 @@ void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
         // RHS could be an explicit null constant or another pointer variable
         PointsToSet R;
         if (isa<ConstantPointerNull>(ValueOp)) {
-            R.insert(std::string("NULL"));
+            R.insert(NullSite);
         } else {
             R = PointsTo[variable(ValueOp)];
         }
 
         // Store writes RHS into memory location(s) pointed to by Pointer
         PointsToSet& L = PointsTo[variable(Pointer)];
-        for (auto& MemLoc : L) {
-            PointsToSet& S = PointsTo[MemLoc];
+        for (SiteID Loc : L) {
+            const std::string& MemLoc = SiteNames[Loc];
             // Union the RHS into what's stored at this memory location
-            PointsToSet Result;
-            std::set_union(S.begin(), S.end(), R.begin(), R.end(),
-                           std::inserter(Result, Result.begin()));
-            if (PointsTo[MemLoc] != Result) {
-                PointsTo[MemLoc] = Result;
+            PointsToSet& Stored = PointsTo[MemLoc];
+            if (Stored.unionWith(R)) {
                 // recompute null state for this memory location
-                auto NewState = computeNullState(MemLoc, PointsTo);
-                if (NullStates[MemLoc] != NewState) {
-                    NullStates[MemLoc] = NewState;
-                    NullChanged = true;
-                }
+                updateNullState(MemLoc, Stored);
             }
         }
 
     } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
         // Always check loads (they dereference a pointer operand) — do not
         // gate on the load result type (the loaded value may be non-pointer).
-        // Check whether we are dereferencing a pointer that may point-to NULL
-        Value* Ptr = Load->getPointerOperand();
-        // set NullState for the value produced by the load
-        auto NewState = computeNullState(variable(Load), PointsTo);
-        if (NullStates[variable(Load)] != NewState) {
-            NullStates[variable(Load)] = NewState;
-            NullChanged = true;
-        }
-
-        std::string VariableName = variable(Load->getPointerOperand());
-        PointsToSet& R = PointsTo[VariableName];
+        PointsToSet& R = PointsTo[variable(Load->getPointerOperand())];
         PointsToSet Result;
-        for (auto& I : R) {
-            PointsToSet& S = PointsTo[I];
-            std::set_union(S.begin(), S.end(), Result.begin(), Result.end(),
-                           std::inserter(Result, Result.begin()));
+        for (SiteID I : R) {
+            Result.unionWith(PointsTo[SiteNames[I]]);
         }
-        PointsTo[variable(Load)] = Result;
+        std::string Var = variable(Load);
+        PointsToSet& S = PointsTo[Var];
+        S = Result;
+        // set NullState for the value produced by the load
+        updateNullState(Var, S);
 
     } else if (auto* Call = dyn_cast<CallInst>(Inst)) {
         if (Call->getType()->isPointerTy()) {
-            PointsToSet& S = PointsTo[variable(Call)];
-            S.insert(address(Call));
-            auto NewState = computeNullState(variable(Call), PointsTo);
-            if (NullStates[variable(Call)] != NewState) {
-                NullStates[variable(Call)] = NewState;
-                NullChanged = true;
-            }
+            std::string Var = variable(Call);
+            PointsToSet& S = PointsTo[Var];
+            S.insert(site(address(Call)));
+            updateNullState(Var, S);
         }
 
     } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
         if (Cast->getType()->isPointerTy() &&
             Cast->getOperand(0)->getType()->isPointerTy()) {
-            PointsTo[variable(Cast)] = PointsTo[variable(Cast->getOperand(0))];
-            auto NewState = computeNullState(variable(Cast), PointsTo);
-            if (NullStates[variable(Cast)] != NewState) {
-                NullStates[variable(Cast)] = NewState;
-                NullChanged = true;
-            }
+            std::string Var = variable(Cast);
+            PointsToSet& S = PointsTo[Var];
+            S = PointsTo[variable(Cast->getOperand(0))];
+            updateNullState(Var, S);
         }
 
     } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
         if (GEP->getType()->isPointerTy()) {
-            PointsTo[variable(GEP)] =
-                PointsTo[variable(GEP->getPointerOperand())];
-            auto NewState = computeNullState(variable(GEP), PointsTo);
-            if (NullStates[variable(GEP)] != NewState) {
-                NullStates[variable(GEP)] = NewState;
-                NullChanged = true;
-            }
+            std::string Var = variable(GEP);
+            PointsToSet& S = PointsTo[Var];
+            S = PointsTo[variable(GEP->getPointerOperand())];
+            updateNullState(Var, S);
         }
 
     } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
@@ -121,184 +97,139 @@ void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
             if (!Incoming->getType()->isPointerTy()) {
                 continue;
             }
-            PointsToSet& S = PointsTo[variable(Incoming)];
-            std::set_union(S.begin(), S.end(), Result.begin(), Result.end(),
-                           std::inserter(Result, Result.begin()));
-        }
-        PointsTo[variable(Phi)] = Result;
-        auto NewState = computeNullState(variable(Phi), PointsTo);
-        if (NullStates[variable(Phi)] != NewState) {
-            NullStates[variable(Phi)] = NewState;
-            NullChanged = true;
+            Result.unionWith(PointsTo[variable(Incoming)]);
         }
+        std::string Var = variable(Phi);
+        PointsToSet& S = PointsTo[Var];
+        S = Result;
+        updateNullState(Var, S);
     }
 }
 
-// Helper: recursively check whether variable `var` may (transitively) point to
-// NULL
-static bool mayPointToNull(const std::string& var, PointsToInfo& PointsTo,
-                           int depth = 3) {
-    if (depth <= 0) return false;
-    auto it = PointsTo.find(var);
-    if (it == PointsTo.end()) return false;
-    const PointsToSet& pts = it->second;
-    for (const auto& t : pts) {
-        if (t == "NULL") return true;
-        // if we have a PointsTo entry for the target, recurse
-        auto it2 = PointsTo.find(t);
-        if (it2 != PointsTo.end()) {
-            if (mayPointToNull(t, PointsTo, depth - 1)) return true;
-        }
-    }
-    return false;
-}
-
 int PointerAnalysis::countFacts(PointsToInfo& PointsTo) {
     int N = 0;
     for (auto& I : PointsTo) N += I.second.size();
     return N;
 }
 
-Domain::NullState PointerAnalysis::computeNullState(const std::string& var,
-                                                    PointsToInfo& PointsTo) {
-    auto it = PointsTo.find(var);
-    if (it == PointsTo.end()) return dataflow::Domain::Unknown;
-    const PointsToSet& pts = it->second;
-    bool hasNull = pts.find(std::string("NULL")) != pts.end();
-    bool hasAddr = false;
-    for (auto& t : pts) {
-        if (t != "NULL") {
-            hasAddr = true;
-            break;
-        }
-    }
+Domain::NullState PointerAnalysis::computeNullState(const PointsToSet& Pts) {
+    bool hasNull = Pts.hasNull();
+    bool hasAddr = Pts.nonNullSize() > 0;
     if (hasNull && !hasAddr) return dataflow::Domain::Null;
     if (!hasNull && hasAddr) return dataflow::Domain::NotNull;
     if (hasNull && hasAddr) return dataflow::Domain::MaybeNull;
     return dataflow::Domain::Unknown;
 }
 
+void PointerAnalysis::updateNullState(const std::string& Var, const PointsToSet& Pts) {
+    auto NewState = computeNullState(Pts);
+    Domain::NullState& State = NullStates[Var];
+    if (State != NewState) {
+        State = NewState;
+        NullChanged = true;
+    }
+}
 
-// Analyze null-check branches and populate GuardedNotNull map
-// Detects patterns like: if (ptr != null) { use ptr }
-void PointerAnalysis::analyzeNullGuards(Function& F) {
-    // Map from memory location (alloca) to guarded blocks
-    std::map<std::string, std::set<BasicBlock*>> MemLocGuardedBlocks;
-
-    for (auto& BB : F) {
-        auto* Term = BB.getTerminator();
-        auto* BI = dyn_cast<BranchInst>(Term);
-        if (!BI || !BI->isConditional()) continue;
 
-        Value* Cond = BI->getCondition();
-        auto* Cmp = dyn_cast<ICmpInst>(Cond);
-        if (!Cmp) continue;
+// Detects patterns like: if (ptr != null) { use ptr }. Guards are only looked
+// for on demand, for dereferences that may be null, by walking up the
+// dominator tree of the dereference.
+bool PointerAnalysis::isNotNullEdge(const Value* Ptr, BasicBlock* Pred,
+                                    BasicBlock* Succ) {
+    auto* BI = dyn_cast<BranchInst>(Pred->getTerminator());
+    if (!BI || !BI->isConditional()) return false;
 
-        Value* LHS = Cmp->getOperand(0);
-        Value* RHS = Cmp->getOperand(1);
+    auto* Cmp = dyn_cast<ICmpInst>(BI->getCondition());
+    if (!Cmp) return false;
 
-        // Check for ptr != null or ptr == null patterns
-        Value* PtrOp = nullptr;
-        if (isa<ConstantPointerNull>(RHS) && LHS->getType()->isPointerTy()) {
-            PtrOp = LHS;
-        } else if (isa<ConstantPointerNull>(LHS) && RHS->getType()->isPointerTy()) {
-            PtrOp = RHS;
-        }
-        if (!PtrOp) continue;
+    Value* LHS = Cmp->getOperand(0);
+    Value* RHS = Cmp->getOperand(1);
 
-        BasicBlock* NotNullBB = nullptr;
-        if (Cmp->getPredicate() == ICmpInst::ICMP_NE) {
-            NotNullBB = BI->getSuccessor(0);  // true branch
-        } else if (Cmp->getPredicate() == ICmpInst::ICMP_EQ) {
-            NotNullBB = BI->getSuccessor(1);  // false branch
-        }
-        if (!NotNullBB) continue;
+    // Check for ptr != null or ptr == null patterns
+    Value* PtrOp = nullptr;
+    if (isa<ConstantPointerNull>(RHS) && LHS->getType()->isPointerTy()) {
+        PtrOp = LHS;
+    } else if (isa<ConstantPointerNull>(LHS) && RHS->getType()->isPointerTy()) {
+        PtrOp = RHS;
+    }
+    if (!PtrOp) return false;
+
+    // The checked value or, for a load, another load of the same memory
+    // location
+    if (PtrOp != Ptr) {
+        auto* Checked = dyn_cast<LoadInst>(PtrOp);
+        auto* Used = dyn_cast<LoadInst>(Ptr);
+        if (!Checked || !Used ||
+            Checked->getPointerOperand() != Used->getPointerOperand())
+            return false;
+    }
 
-        std::string guardedVar = variable(PtrOp);
-        GuardedNotNull[NotNullBB].insert(guardedVar);
+    BasicBlock* NotNullBB = nullptr;
+    if (Cmp->getPredicate() == ICmpInst::ICMP_NE) {
+        NotNullBB = BI->getSuccessor(0);  // true branch
+    } else if (Cmp->getPredicate() == ICmpInst::ICMP_EQ) {
+        NotNullBB = BI->getSuccessor(1);  // false branch
+    }
+    if (NotNullBB != Succ) return false;
 
-        // Track memory location for loads
-        if (auto* Load = dyn_cast<LoadInst>(PtrOp)) {
-            Value* LoadPtr = Load->getPointerOperand();
-            std::string memLoc = variable(LoadPtr);
-            MemLocGuardedBlocks[memLoc].insert(NotNullBB);
-        }
+    // The edge must be the only way into Succ, so that it dominates every
+    // block Succ dominates, join points included
+    return DT->dominates(BasicBlockEdge(Pred, Succ), Succ);
+}
 
-        // Propagate to single-predecessor successors
-        std::queue<BasicBlock*> Worklist;
-        Worklist.push(NotNullBB);
-        std::set<BasicBlock*> Visited;
-        Visited.insert(NotNullBB);
-
-        while (!Worklist.empty()) {
-            BasicBlock* Curr = Worklist.front();
-            Worklist.pop();
-            for (BasicBlock* Succ : successors(Curr)) {
-                if (Succ->hasNPredecessors(1) && Visited.find(Succ) == Visited.end()) {
-                    for (const auto& g : GuardedNotNull[Curr]) {
-                        GuardedNotNull[Succ].insert(g);
-                    }
-                    if (auto* Load = dyn_cast<LoadInst>(PtrOp)) {
-                        Value* LoadPtr = Load->getPointerOperand();
-                        std::string memLoc = variable(LoadPtr);
-                        MemLocGuardedBlocks[memLoc].insert(Succ);
-                    }
-                    Visited.insert(Succ);
-                    Worklist.push(Succ);
-                }
-            }
+bool PointerAnalysis::isGuardedIn(const Value* Ptr, BasicBlock* BB) {
+    // A guarding edge ends in a dominator of BB, so check the edges into
+    // each block up the dominator tree until a memoized answer
+    SmallVector<BasicBlock*, 16> Path;
+    bool Guarded = false;
+    for (auto* Node = DT->getNode(BB); Node; Node = Node->getIDom()) {
+        BasicBlock* Dom = Node->getBlock();
+        auto it = GuardedIn.find({Ptr, Dom});
+        if (it != GuardedIn.end()) {
+            Guarded = it->second;
+            break;
         }
-    }
-
-    // For each load, if from guarded memory location in guarded block, mark result guarded
-    for (auto& BB : F) {
-        for (auto& I : BB) {
-            if (auto* Load = dyn_cast<LoadInst>(&I)) {
-                if (!Load->getType()->isPointerTy()) continue;
-                Value* LoadPtr = Load->getPointerOperand();
-                std::string memLoc = variable(LoadPtr);
-                auto it = MemLocGuardedBlocks.find(memLoc);
-                if (it != MemLocGuardedBlocks.end()) {
-                    if (it->second.find(&BB) != it->second.end()) {
-                        GuardedNotNull[&BB].insert(variable(Load));
-                    }
-                }
-            }
-            if (auto* GEP = dyn_cast<GetElementPtrInst>(&I)) {
-                Value* BasePtr = GEP->getPointerOperand();
-                std::string baseVar = variable(BasePtr);
-                if (GuardedNotNull[&BB].find(baseVar) != GuardedNotNull[&BB].end()) {
-                    GuardedNotNull[&BB].insert(variable(GEP));
-                }
-            }
+        Path.push_back(Dom);
+        if (llvm::any_of(predecessors(Dom), [&](BasicBlock* Pred) {
+                return isNotNullEdge(Ptr, Pred, Dom);
+            })) {
+            Guarded = true;
+            break;
         }
     }
+    // The blocks below the one the walk stopped at share its answer
+    for (BasicBlock* Dom : Path) GuardedIn[{Ptr, Dom}] = Guarded;
+    return Guarded;
 }
 
-bool PointerAnalysis::isGuardedNotNull(const std::string& ptrVar, Instruction* Inst) {
+bool PointerAnalysis::isGuardedNotNull(const Value* Ptr, Instruction* Inst) {
     BasicBlock* BB = Inst->getParent();
-    auto it = GuardedNotNull.find(BB);
-    if (it == GuardedNotNull.end()) return false;
-
-    if (it->second.find(ptrVar) != it->second.end()) return true;
-
-    if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
-        Value* BasePtr = GEP->getPointerOperand();
-        std::string baseVar = variable(BasePtr);
-        if (it->second.find(baseVar) != it->second.end()) return true;
-    } else if (auto* Load = dyn_cast<LoadInst>(Inst)) {
-        Value* Ptr = Load->getPointerOperand();
-        std::string loadPtrVar = variable(Ptr);
-        if (it->second.find(loadPtrVar) != it->second.end()) return true;
+    if (!DT) DT = std::make_unique<DominatorTree>(*Inst->getFunction());
+
+    // A GEP or cast of a NotNull pointer is NotNull too, so walk down to the
+    // checked pointer
+    while (true) {
+        if (isGuardedIn(Ptr, BB)) return true;
+        if (auto* GEP = dyn_cast<GetElementPtrInst>(Ptr)) {
+            Ptr = GEP->getPointerOperand();
+        } else if (auto* Cast = dyn_cast<CastInst>(Ptr)) {
+            if (!Cast->getOperand(0)->getType()->isPointerTy()) return false;
+            Ptr = Cast->getOperand(0);
+        } else {
+            return false;
+        }
     }
-    return false;
 }
 
 void PointerAnalysis::print(std::map<std::string, PointsToSet>& PointsTo) {
     errs() << "Pointer Analysis Results:\n";
     for (auto& I : PointsTo) {
         errs() << "  " << I.first << ": { ";
-        for (auto& J : I.second) {
+        // In name order, as sites are numbered in the order they are found
+        std::vector<std::string> Names;
+        for (SiteID J : I.second) Names.push_back(SiteNames[J]);
+        std::sort(Names.begin(), Names.end());
+        for (auto& J : Names) {
             errs() << J << "; ";
         }
         errs() << "}\n";
@@ -306,15 +237,27 @@ void PointerAnalysis::print(std::map<std::string, PointsToSet>& PointsTo) {
     errs() << "\n";
 }
 
+SiteID PointerAnalysis::site(const std::string& Name) {
+    auto It = SiteIDs.find(Name);
+    if (It != SiteIDs.end()) return It->second;
+
+    SiteID Site = SiteNames.size();
+    SiteIDs[Name] = Site;
+    SiteNames.push_back(Name);
+    return Site;
+}
+
 PointerAnalysis::PointerAnalysis(Function& F) {
     FuncName = F.getName().str();
+    // The first site, so that it gets the ID reserved for NULL
+    site("NULL");
     int NumOfOldFacts = 0;
     int NumOfNewFacts = 0;
 
     for (auto& Arg : F.args()) {
         if (Arg.getType()->isPointerTy()) {
             PointsToSet& S = PointsTo[variable(&Arg)];
-            S.insert(address(&Arg));
+            S.insert(site(address(&Arg)));
         }
     }
 
@@ -338,29 +281,14 @@ PointerAnalysis::PointerAnalysis(Function& F) {
         }
     }
 
-    // After reaching fixpoint, compute NullStates for each variable
+    // Transfers keep the NullState of every set they change up to date; the
+    // sets that were only read so far have none yet
     for (auto& I : PointsTo) {
-        const auto& var = I.first;
-        const PointsToSet& pts = I.second;
-        bool hasNull = pts.find(std::string("NULL")) != pts.end();
-        bool hasAddr = false;
-        for (auto& t : pts) {
-            if (t != "NULL") {
-                hasAddr = true;
-                break;
-            }
-        }
-        if (hasNull && !hasAddr) {
-            NullStates[var] = Domain::Null;
-        } else if (!hasNull && hasAddr) {
-            NullStates[var] = Domain::NotNull;
-        } else if (hasNull && hasAddr) {
-            NullStates[var] = Domain::MaybeNull;
-        } else {
-            NullStates[var] = Domain::Unknown;
-        }
+        NullStates.emplace(I.first, computeNullState(I.second));
     }
+}
 
+void PointerAnalysis::report(Function& F) {
     print(PointsTo);
     // print nullness summary
     errs() << "Nullness Summary:\n";
@@ -383,10 +311,6 @@ PointerAnalysis::PointerAnalysis(Function& F) {
         errs() << "\n";
     }
 
-
-    // Analyze null guards (short-circuit evaluation patterns)
-    analyzeNullGuards(F);
-
     // Post-check: iterate instructions again and emit warnings based on the
     // final PointsTo sets (more reliable than checking during transfer).
     for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E;
@@ -395,16 +319,20 @@ PointerAnalysis::PointerAnalysis(Function& F) {
         if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
             Value* Pointer = Store->getPointerOperand();
             auto it = NullStates.find(variable(Pointer));
-            if (it != NullStates.end() && !isGuardedNotNull(variable(Pointer), Inst) && (it->second == Domain::Null ||
-                                           it->second == Domain::MaybeNull)) {
+            if (it != NullStates.end() &&
+                (it->second == Domain::Null ||
+                 it->second == Domain::MaybeNull) &&
+                !isGuardedNotNull(Pointer, Inst)) {
                 errs() << "Possible null dereference (store) in " << FuncName
                        << " at: " << *Store << "\n";
             }
         } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
             Value* Pointer = Load->getPointerOperand();
             auto it = NullStates.find(variable(Pointer));
-            if (it != NullStates.end() && !isGuardedNotNull(variable(Pointer), Inst) && (it->second == Domain::Null ||
-                                           it->second == Domain::MaybeNull)) {
+            if (it != NullStates.end() &&
+                (it->second == Domain::Null ||
+                 it->second == Domain::MaybeNull) &&
+                !isGuardedNotNull(Pointer, Inst)) {
                 errs() << "Possible null dereference (load) in " << FuncName
                        << " at: " << *Load << "\n";
             }
@@ -413,8 +341,10 @@ PointerAnalysis::PointerAnalysis(Function& F) {
             // access memory)
             Value* Pointer = GEP->getPointerOperand();
             auto it = NullStates.find(variable(Pointer));
-            if (it != NullStates.end() && !isGuardedNotNull(variable(Pointer), Inst) && (it->second == Domain::Null ||
-                                           it->second == Domain::MaybeNull)) {
+            if (it != NullStates.end() &&
+                (it->second == Domain::Null ||
+                 it->second == Domain::MaybeNull) &&
+                !isGuardedNotNull(Pointer, Inst)) {
                 errs() << "Possible null dereference (getelementptr) in "
                        << FuncName << " at: " << *GEP << "\n";
             }
@@ -422,17 +352,25 @@ PointerAnalysis::PointerAnalysis(Function& F) {
     }
 }
 
+AnalysisKey NullPointsToAnalysis::Key;
+
 bool PointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
     if (PointsTo.find(Ptr1) == PointsTo.end() ||
         PointsTo.find(Ptr2) == PointsTo.end())
         return false;
     const PointsToSet& S1 = PointsTo.at(Ptr1);
     const PointsToSet& S2 = PointsTo.at(Ptr2);
+    return S1.intersects(S2);
+}
 
-    PointsToSet Inter;
-    std::set_intersection(S1.begin(), S1.end(), S2.begin(), S2.end(),
-                          std::inserter(Inter, Inter.begin()));
-    return !Inter.empty();
+std::vector<std::string> PointerAnalysis::pointees(const Value* Ptr) const {
+    std::vector<std::string> Names;
+    auto it = PointsTo.find(variable(Ptr));
+    if (it == PointsTo.end()) return Names;
+    for (SiteID Site : it->second) {
+        if (Site != NullSite) Names.push_back(SiteNames[Site]);
+    }
+    return Names;
 }
 
 //===----------------------------------------------------------------------===//
@@ -448,13 +386,15 @@ struct NullPointerAnalysisPass
                                 llvm::ModuleAnalysisManager& AM) {
         llvm::outs() << "Running " << PASS_DESC << " on module " << M.getName()
                      << "\n";
+        auto& FAM =
+            AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
 
         for (auto& F : M) {
             if (F.isDeclaration()) continue;
             llvm::outs() << "Running " << PASS_NAME << " on " << F.getName()
                          << "\n";
-            // construct the analysis which prints its results
-            PointerAnalysis PA(F);
+            // solved once per function and cached in the analysis manager
+            FAM.getResult<NullPointsToAnalysis>(F).report(F);
         }
 
         return llvm::PreservedAnalyses::all();
@@ -465,6 +405,10 @@ extern "C" LLVM_ATTRIBUTE_WEAK llvm::PassPluginLibraryInfo
 llvmGetPassPluginInfo() {
     return {LLVM_PLUGIN_API_VERSION, PASS_NAME, "1.0.0",
             [](llvm::PassBuilder& PB) {
+                PB.registerAnalysisRegistrationCallback(
+                    [](FunctionAnalysisManager& FAM) {
+                        FAM.registerPass([] { return NullPointsToAnalysis(); });
+                    });
                 PB.registerPipelineParsingCallback(
                     [](llvm::StringRef Name, llvm::ModulePassManager& MPM,
                        llvm::ArrayRef<llvm::PassBuilder::PipelineElement>) {
@@ -472,6 +416,10 @@ llvmGetPassPluginInfo() {
                             MPM.addPass(NullPointerAnalysisPass());
                             return true;
                         }
+                        if (Name == "NullDataflow") {
+                            MPM.addPass(NullDataflowAnalysis());
+                            return true;
+                        }
                         return false;
                     });
             }};
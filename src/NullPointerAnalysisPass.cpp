@@ -1,3 +1,4 @@
+#include "NullDataflowAnalysis.h"
 #include "NullPointerAnalysis.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
@@ -15,13 +16,14 @@ struct NullPointerAnalysisPass : public PassInfoMixin<NullPointerAnalysisPass> {
     PreservedAnalyses run(Module& M, ModuleAnalysisManager& AM) {
         outs() << "Running " << PASS_DESC << " on module " << M.getName()
                << "\n";
+        auto& FAM =
+            AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
 
         for (auto& F : M) {
             if (F.isDeclaration()) continue;
             outs() << "Running " << PASS_NAME << " on " << F.getName() << "\n";
-            // PointerAnalysis constructor performs the fixpoint and prints
-            // results
-            PointerAnalysis PA(F);
+            // Solved once per function and cached in the analysis manager
+            FAM.getResult<NullPointsToAnalysis>(F).report(F);
         }
 
         return PreservedAnalyses::all();
@@ -31,6 +33,10 @@ struct NullPointerAnalysisPass : public PassInfoMixin<NullPointerAnalysisPass> {
 // Pass registration for the new pass manager
 extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
     return {LLVM_PLUGIN_API_VERSION, PASS_NAME, "1.0.0", [](PassBuilder& PB) {
+                PB.registerAnalysisRegistrationCallback(
+                    [](FunctionAnalysisManager& FAM) {
+                        FAM.registerPass([] { return NullPointsToAnalysis(); });
+                    });
                 PB.registerPipelineParsingCallback(
                     [](StringRef Name, ModulePassManager& MPM,
                        ArrayRef<PassBuilder::PipelineElement>) {
@@ -38,6 +44,10 @@ extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
                             MPM.addPass(NullPointerAnalysisPass());
                             return true;
                         }
+                        if (Name == "NullDataflow") {
+                            MPM.addPass(NullDataflowAnalysis());
+                            return true;
+                        }
                         return false;
                     });
             }};
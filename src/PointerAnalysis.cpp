@@ -8,18 +8,17 @@
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/PassPlugin.h"
 
+#include <algorithm>
+
 namespace dataflow {
 
 void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
   if (AllocaInst* Alloca = dyn_cast<AllocaInst>(Inst)) {
-    PointsToSet& S = PointsTo[variable(Alloca)];
-    S.insert(address(Alloca));
+    std::string Var = variable(Alloca);
+    PointsToSet& S = PointsTo[Var];
+    S.insert(site(address(Alloca)));
     // update null state for the allocated variable
-    auto NewState = computeNullState(variable(Alloca), PointsTo);
-    if (NullStates[variable(Alloca)] != NewState) {
-      NullStates[variable(Alloca)] = NewState;
-      NullChanged = true;
-    }
+    updateNullState(Var, S);
 
   } else if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
     Value* Pointer = Store->getPointerOperand();
@@ -32,84 +31,59 @@ void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
     // RHS could be an explicit null constant or another pointer variable
     PointsToSet R;
     if (isa<ConstantPointerNull>(ValueOp)) {
-      R.insert(std::string("NULL"));
+      R.insert(NullSite);
     } else {
       R = PointsTo[variable(ValueOp)];
     }
 
     // Store writes RHS into memory location(s) pointed to by Pointer
     PointsToSet& L = PointsTo[variable(Pointer)];
-    for (auto& MemLoc : L) {
-      PointsToSet& S = PointsTo[MemLoc];
+    for (SiteID Loc : L) {
+      const std::string& MemLoc = SiteNames[Loc];
       // Union the RHS into what's stored at this memory location
-      PointsToSet Result;
-      std::set_union(
-          S.begin(), S.end(), R.begin(), R.end(), std::inserter(Result, Result.begin()));
-      if (PointsTo[MemLoc] != Result) {
-        PointsTo[MemLoc] = Result;
+      PointsToSet& Stored = PointsTo[MemLoc];
+      if (Stored.unionWith(R)) {
         // recompute null state for this memory location
-        auto NewState = computeNullState(MemLoc, PointsTo);
-        if (NullStates[MemLoc] != NewState) {
-          NullStates[MemLoc] = NewState;
-          NullChanged = true;
-        }
+        updateNullState(MemLoc, Stored);
       }
     }
 
   } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
     // Always check loads (they dereference a pointer operand) — do not
     // gate on the load result type (the loaded value may be non-pointer).
-    // Check whether we are dereferencing a pointer that may point-to NULL
-    Value* Ptr = Load->getPointerOperand();
-    // set NullState for the value produced by the load
-    auto NewState = computeNullState(variable(Load), PointsTo);
-    if (NullStates[variable(Load)] != NewState) {
-      NullStates[variable(Load)] = NewState;
-      NullChanged = true;
-    }
-
-    std::string VariableName = variable(Load->getPointerOperand());
-    PointsToSet& R = PointsTo[VariableName];
+    PointsToSet& R = PointsTo[variable(Load->getPointerOperand())];
     PointsToSet Result;
-    for (auto& I : R) {
-      PointsToSet& S = PointsTo[I];
-      std::set_union(S.begin(),
-          S.end(),
-          Result.begin(),
-          Result.end(),
-          std::inserter(Result, Result.begin()));
+    for (SiteID I : R) {
+      Result.unionWith(PointsTo[SiteNames[I]]);
     }
-    PointsTo[variable(Load)] = Result;
+    std::string Var = variable(Load);
+    PointsToSet& S = PointsTo[Var];
+    S = Result;
+    // set NullState for the value produced by the load
+    updateNullState(Var, S);
 
   } else if (auto* Call = dyn_cast<CallInst>(Inst)) {
     if (Call->getType()->isPointerTy()) {
-      PointsToSet& S = PointsTo[variable(Call)];
-      S.insert(address(Call));
-      auto NewState = computeNullState(variable(Call), PointsTo);
-      if (NullStates[variable(Call)] != NewState) {
-        NullStates[variable(Call)] = NewState;
-        NullChanged = true;
-      }
+      std::string Var = variable(Call);
+      PointsToSet& S = PointsTo[Var];
+      S.insert(site(address(Call)));
+      updateNullState(Var, S);
     }
 
   } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
     if (Cast->getType()->isPointerTy() && Cast->getOperand(0)->getType()->isPointerTy()) {
-      PointsTo[variable(Cast)] = PointsTo[variable(Cast->getOperand(0))];
-      auto NewState = computeNullState(variable(Cast), PointsTo);
-      if (NullStates[variable(Cast)] != NewState) {
-        NullStates[variable(Cast)] = NewState;
-        NullChanged = true;
-      }
+      std::string Var = variable(Cast);
+      PointsToSet& S = PointsTo[Var];
+      S = PointsTo[variable(Cast->getOperand(0))];
+      updateNullState(Var, S);
     }
 
   } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
     if (GEP->getType()->isPointerTy()) {
-      PointsTo[variable(GEP)] = PointsTo[variable(GEP->getPointerOperand())];
-      auto NewState = computeNullState(variable(GEP), PointsTo);
-      if (NullStates[variable(GEP)] != NewState) {
-        NullStates[variable(GEP)] = NewState;
-        NullChanged = true;
-      }
+      std::string Var = variable(GEP);
+      PointsToSet& S = PointsTo[Var];
+      S = PointsTo[variable(GEP->getPointerOperand())];
+      updateNullState(Var, S);
     }
 
   } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
@@ -123,43 +97,13 @@ void PointerAnalysis::transfer(Instruction* Inst, PointsToInfo& PointsTo) {
       if (!Incoming->getType()->isPointerTy()) {
         continue;
       }
-      PointsToSet& S = PointsTo[variable(Incoming)];
-      std::set_union(S.begin(),
-          S.end(),
-          Result.begin(),
-          Result.end(),
-          std::inserter(Result, Result.begin()));
-    }
-    PointsTo[variable(Phi)] = Result;
-    auto NewState = computeNullState(variable(Phi), PointsTo);
-    if (NullStates[variable(Phi)] != NewState) {
-      NullStates[variable(Phi)] = NewState;
-      NullChanged = true;
-    }
-  }
-}
-
-// Helper: recursively check whether variable `var` may (transitively) point to
-// NULL
-static bool mayPointToNull(
-    const std::string& var, PointsToInfo& PointsTo, int depth = 3) {
-  if (depth <= 0)
-    return false;
-  auto it = PointsTo.find(var);
-  if (it == PointsTo.end())
-    return false;
-  const PointsToSet& pts = it->second;
-  for (const auto& t : pts) {
-    if (t == "NULL")
-      return true;
-    // if we have a PointsTo entry for the target, recurse
-    auto it2 = PointsTo.find(t);
-    if (it2 != PointsTo.end()) {
-      if (mayPointToNull(t, PointsTo, depth - 1))
-        return true;
+      Result.unionWith(PointsTo[variable(Incoming)]);
     }
+    std::string Var = variable(Phi);
+    PointsToSet& S = PointsTo[Var];
+    S = Result;
+    updateNullState(Var, S);
   }
-  return false;
 }
 
 int PointerAnalysis::countFacts(PointsToInfo& PointsTo) {
@@ -169,20 +113,9 @@ int PointerAnalysis::countFacts(PointsToInfo& PointsTo) {
   return N;
 }
 
-Domain::NullState PointerAnalysis::computeNullState(
-    const std::string& var, PointsToInfo& PointsTo) {
-  auto it = PointsTo.find(var);
-  if (it == PointsTo.end())
-    return dataflow::Domain::Unknown;
-  const PointsToSet& pts = it->second;
-  bool hasNull = pts.find(std::string("NULL")) != pts.end();
-  bool hasAddr = false;
-  for (auto& t : pts) {
-    if (t != "NULL") {
-      hasAddr = true;
-      break;
-    }
-  }
+Domain::NullState PointerAnalysis::computeNullState(const PointsToSet& Pts) {
+  bool hasNull = Pts.hasNull();
+  bool hasAddr = Pts.nonNullSize() > 0;
   if (hasNull && !hasAddr)
     return dataflow::Domain::Null;
   if (!hasNull && hasAddr)
@@ -192,11 +125,25 @@ Domain::NullState PointerAnalysis::computeNullState(
   return dataflow::Domain::Unknown;
 }
 
+void PointerAnalysis::updateNullState(const std::string& Var, const PointsToSet& Pts) {
+  auto NewState = computeNullState(Pts);
+  Domain::NullState& State = NullStates[Var];
+  if (State != NewState) {
+    State = NewState;
+    NullChanged = true;
+  }
+}
+
 void PointerAnalysis::print(std::map<std::string, PointsToSet>& PointsTo) {
   errs() << "Pointer Analysis Results:\n";
   for (auto& I : PointsTo) {
     errs() << "  " << I.first << ": { ";
-    for (auto& J : I.second) {
+    // In name order, as sites are numbered in the order they are found
+    std::vector<std::string> Names;
+    for (SiteID J : I.second)
+      Names.push_back(SiteNames[J]);
+    std::sort(Names.begin(), Names.end());
+    for (auto& J : Names) {
       errs() << J << "; ";
     }
     errs() << "}\n";
@@ -204,15 +151,28 @@ void PointerAnalysis::print(std::map<std::string, PointsToSet>& PointsTo) {
   errs() << "\n";
 }
 
+SiteID PointerAnalysis::site(const std::string& Name) {
+  auto It = SiteIDs.find(Name);
+  if (It != SiteIDs.end())
+    return It->second;
+
+  SiteID Site = SiteNames.size();
+  SiteIDs[Name] = Site;
+  SiteNames.push_back(Name);
+  return Site;
+}
+
 PointerAnalysis::PointerAnalysis(Function& F) {
   FuncName = F.getName().str();
+  // The first site, so that it gets the ID reserved for NULL
+  site("NULL");
   int NumOfOldFacts = 0;
   int NumOfNewFacts = 0;
 
   for (auto& Arg : F.args()) {
     if (Arg.getType()->isPointerTy()) {
       PointsToSet& S = PointsTo[variable(&Arg)];
-      S.insert(address(&Arg));
+      S.insert(site(address(&Arg)));
     }
   }
 
@@ -235,29 +195,14 @@ PointerAnalysis::PointerAnalysis(Function& F) {
     }
   }
 
-  // After reaching fixpoint, compute NullStates for each variable
+  // Transfers keep the NullState of every set they change up to date; the
+  // sets that were only read so far have none yet
   for (auto& I : PointsTo) {
-    const auto& var = I.first;
-    const PointsToSet& pts = I.second;
-    bool hasNull = pts.find(std::string("NULL")) != pts.end();
-    bool hasAddr = false;
-    for (auto& t : pts) {
-      if (t != "NULL") {
-        hasAddr = true;
-        break;
-      }
-    }
-    if (hasNull && !hasAddr) {
-      NullStates[var] = Domain::Null;
-    } else if (!hasNull && hasAddr) {
-      NullStates[var] = Domain::NotNull;
-    } else if (hasNull && hasAddr) {
-      NullStates[var] = Domain::MaybeNull;
-    } else {
-      NullStates[var] = Domain::Unknown;
-    }
+    NullStates.emplace(I.first, computeNullState(I.second));
   }
+}
 
+void PointerAnalysis::report(Function& F) {
   print(PointsTo);
   // print nullness summary
   errs() << "Nullness Summary:\n";
@@ -314,16 +259,14 @@ PointerAnalysis::PointerAnalysis(Function& F) {
   }
 }
 
+AnalysisKey NullPointsToAnalysis::Key;
+
 bool PointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
   if (PointsTo.find(Ptr1) == PointsTo.end() || PointsTo.find(Ptr2) == PointsTo.end())
     return false;
   const PointsToSet& S1 = PointsTo.at(Ptr1);
   const PointsToSet& S2 = PointsTo.at(Ptr2);
-
-  PointsToSet Inter;
-  std::set_intersection(
-      S1.begin(), S1.end(), S2.begin(), S2.end(), std::inserter(Inter, Inter.begin()));
-  return !Inter.empty();
+  return S1.intersects(S2);
 }
 
 //===----------------------------------------------------------------------===//
@@ -336,13 +279,14 @@ const auto PASS_DESC = "Null pointer dereference: Constraint-Based Analysis";
 struct PointerAnalysisPass : public llvm::PassInfoMixin<PointerAnalysisPass> {
   llvm::PreservedAnalyses run(llvm::Module& M, llvm::ModuleAnalysisManager& AM) {
     llvm::outs() << "Running " << PASS_DESC << " on module " << M.getName() << "\n";
+    auto& FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
 
     for (auto& F : M) {
       if (F.isDeclaration())
         continue;
       llvm::outs() << "Running " << PASS_NAME << " on " << F.getName() << "\n";
-      // construct the analysis which prints its results
-      PointerAnalysis PA(F);
+      // solved once per function and cached in the analysis manager
+      FAM.getResult<NullPointsToAnalysis>(F).report(F);
     }
 
     return llvm::PreservedAnalyses::all();
@@ -351,6 +295,9 @@ struct PointerAnalysisPass : public llvm::PassInfoMixin<PointerAnalysisPass> {
 
 extern "C" LLVM_ATTRIBUTE_WEAK llvm::PassPluginLibraryInfo llvmGetPassPluginInfo() {
   return {LLVM_PLUGIN_API_VERSION, PASS_NAME, "1.0.0", [](llvm::PassBuilder& PB) {
+            PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager& FAM) {
+              FAM.registerPass([] { return NullPointsToAnalysis(); });
+            });
             PB.registerPipelineParsingCallback(
                 [](llvm::StringRef Name,
                     llvm::ModulePassManager& MPM,
@@ -0,0 +1,368 @@
+#include "PointsToBackend.h"
+
+#include "BDDPointerAnalysis.h"
+#include "DoubleFreePointerAnalysis.h"
+#include "FlowSensitivePointerAnalysis.h"
+#include "ModulePointerAnalysis.h"
+#include "SteensgaardPointerAnalysis.h"
+#include "Utils.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/abi-breaking.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+
+#include <chrono>
+
+#define DEBUG_TYPE "points-to"
+
+namespace dataflow {
+
+ALWAYS_ENABLED_STATISTIC(NumAliasCacheHits, "Alias queries answered by the memo");
+ALWAYS_ENABLED_STATISTIC(NumAliasCacheMisses, "Alias queries answered by the solver");
+ALWAYS_ENABLED_STATISTIC(NumAliasesVisited, "Aliases returned to the transfer functions");
+
+std::set<std::string> PointsToBackend::pointerVariables(Function& F) {
+  std::set<std::string> Names;
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy()) {
+      Names.insert(variable(&Arg));
+    }
+  }
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    if (Iter->getType()->isPointerTy()) {
+      Names.insert(variable(&*Iter));
+    }
+  }
+  return Names;
+}
+
+const std::vector<std::string>& PointsToBackend::aliasesOf(const Value* V) {
+  auto It = AliasesCache.find(V);
+  if (It != AliasesCache.end()) {
+    CacheHits++;
+    NumAliasCacheHits++;
+    NumAliasesVisited += It->second.size();
+    return It->second;
+  }
+
+  CacheMisses++;
+  NumAliasCacheMisses++;
+  std::vector<std::string>& Aliases = AliasesCache[V] = aliases(variable(V));
+  NumAliasesVisited += Aliases.size();
+  return Aliases;
+}
+
+void PointsToBackend::clearAliasCache() {
+  AliasesCache.clear();
+}
+
+PointsToBackend* createPointsToBackend(Function& F, const PointsToOptions& Options) {
+  switch (Options.Mode) {
+    case PointsToMode::Steensgaard:
+      return new SteensgaardPointerAnalysis(F);
+
+    case PointsToMode::Prefilter: {
+      // Steensgaard over-approximates Andersen, so if it proves that no freed
+      // pointer has an alias, Andersen would answer every query made by the
+      // transfer functions the same way.
+      auto* Fast = new SteensgaardPointerAnalysis(F);
+      if (!Fast->freesMayAlias(F)) {
+        return Fast;
+      }
+      delete Fast;
+      return new DoubleFreePointerAnalysis(F, Options.MaxFields, Options.Stats);
+    }
+
+    case PointsToMode::BDD:
+      return new BDDPointerAnalysis(F);
+
+    case PointsToMode::Module: {
+      auto Solution = std::make_unique<ModulePointerAnalysis>(*F.getParent());
+      Solution->solve(Options.Verify, Options.Reduce);
+      return new ModulePointsToView(std::move(Solution), F);
+    }
+
+    case PointsToMode::FlowSensitive:
+      return new FlowSensitivePointerAnalysis(F);
+
+    case PointsToMode::Andersen:
+      break;
+  }
+  return new DoubleFreePointerAnalysis(F, Options.MaxFields, Options.Stats);
+}
+
+void printPointsToStatistics() {
+  // LLVM prints statistics at exit when it was built with them, which the
+  // ABI breaking checks tell as they follow its assertions
+#if !LLVM_FORCE_ENABLE_STATS && !LLVM_ENABLE_ABI_BREAKING_CHECKS
+  if (!AreStatisticsEnabled())
+    return;
+
+  std::vector<TrackingStatistic*> Statistics = {
+      &NumAliasCacheHits, &NumAliasCacheMisses, &NumAliasesVisited};
+  ArrayRef<TrackingStatistic*> Solver = DoubleFreePointerAnalysis::statistics();
+  Statistics.insert(Statistics.end(), Solver.begin(), Solver.end());
+
+  // Laid out as PrintStatistics() does, skipping the counters never bumped
+  size_t MaxValueLen = 0, MaxDebugTypeLen = 0;
+  for (TrackingStatistic* Stat : Statistics) {
+    if (!Stat->getValue())
+      continue;
+    MaxValueLen = std::max(MaxValueLen, utostr(Stat->getValue()).size());
+    MaxDebugTypeLen = std::max(MaxDebugTypeLen, strlen(Stat->getDebugType()));
+  }
+  if (!MaxValueLen)
+    return;
+
+  raw_ostream& OS = errs();
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                          ... Statistics Collected ...\n"
+     << "===" << std::string(73, '-') << "===\n\n";
+  for (TrackingStatistic* Stat : Statistics) {
+    if (Stat->getValue()) {
+      OS << format("%*" PRIu64 " %-*s - %s\n", int(MaxValueLen), Stat->getValue(),
+          int(MaxDebugTypeLen), Stat->getDebugType(), Stat->getDesc());
+      *Stat = 0;
+    }
+  }
+  OS << "\n";
+#endif
+}
+
+PointsToBackend& getPointsToBackend(
+    Function& F, const PointsToOptions& Options, ModuleAnalysisManager& AM) {
+  Module& M = *F.getParent();
+  if (Options.Mode == PointsToMode::Module) {
+    ModulePointerAnalysis& Solution = AM.getResult<ModulePointsToAnalysis>(M);
+    Solution.solve(Options.Verify, Options.Reduce);
+    return Solution.function(F);
+  }
+  auto& FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  return FAM.getResult<PointsToAnalysis>(F).get(Options);
+}
+
+PointsToBackend& PointsToAnalysis::Result::get(const PointsToOptions& Options) {
+  std::unique_ptr<PointsToBackend>& Backend = Backends[Options];
+  if (!Backend) {
+    Backend.reset(createPointsToBackend(*F, Options));
+  }
+  return *Backend;
+}
+
+bool PointsToAnalysis::Result::invalidate(
+    Function& F, const PreservedAnalyses& PA, FunctionAnalysisManager::Invalidator& Inv) {
+  auto PAC = PA.getChecker<PointsToAnalysis>();
+  return !(PAC.preserved() || PAC.preservedSet<AllAnalysesOn<Function>>());
+}
+
+void PointsToAnalysis::Result::removeInstructions(ArrayRef<Instruction*> Insts) {
+  for (auto It = Backends.begin(); It != Backends.end();) {
+    if (It->first.Mode == PointsToMode::Andersen && It->second) {
+      static_cast<DoubleFreePointerAnalysis&>(*It->second).removeInstructions(Insts);
+      ++It;
+    } else {
+      It = Backends.erase(It);
+    }
+  }
+}
+
+void PointsToAnalysis::Result::addInstructions(ArrayRef<Instruction*> Insts) {
+  for (auto It = Backends.begin(); It != Backends.end();) {
+    if (It->first.Mode == PointsToMode::Andersen && It->second) {
+      static_cast<DoubleFreePointerAnalysis&>(*It->second).addInstructions(Insts);
+      ++It;
+    } else {
+      It = Backends.erase(It);
+    }
+  }
+}
+
+PointsToAnalysis::Result PointsToAnalysis::run(Function& F, FunctionAnalysisManager& AM) {
+  return Result(F);
+}
+
+bool parsePointsToOptions(StringRef Name, StringRef PassName, PointsToOptions& Options) {
+  if (!Name.consume_front(PassName))
+    return false;
+
+  Options = PointsToOptions();
+  if (Name.empty())
+    return true;
+
+  if (!Name.consume_front("<") || !Name.consume_back(">"))
+    return false;
+
+  while (!Name.empty()) {
+    StringRef Param;
+    std::tie(Param, Name) = Name.split(';');
+
+    if (Param == "andersen") {
+      Options.Mode = PointsToMode::Andersen;
+    } else if (Param == "steensgaard") {
+      Options.Mode = PointsToMode::Steensgaard;
+    } else if (Param == "prefilter") {
+      Options.Mode = PointsToMode::Prefilter;
+    } else if (Param == "bdd") {
+      Options.Mode = PointsToMode::BDD;
+    } else if (Param == "module") {
+      Options.Mode = PointsToMode::Module;
+    } else if (Param == "flowsensitive") {
+      Options.Mode = PointsToMode::FlowSensitive;
+    } else if (Param.consume_front("fields=")) {
+      if (Param.getAsInteger(10, Options.MaxFields))
+        return false;
+    } else if (Param.consume_front("threads=")) {
+      if (Param.getAsInteger(10, Options.Threads))
+        return false;
+    } else if (Param == "verify") {
+      Options.Verify = true;
+    } else if (Param.consume_front("edits=")) {
+      if (Param.getAsInteger(10, Options.Edits))
+        return false;
+    } else if (Param == "stats") {
+      Options.Stats = true;
+    } else if (Param == "noreduce") {
+      Options.Reduce = false;
+    } else if (Param.consume_front("cache=")) {
+      if (Param.empty())
+        return false;
+      Options.CacheDir = Param.str();
+    } else if (Param.consume_front("index=")) {
+      if (Param.empty())
+        return false;
+      Options.IndexFile = Param.str();
+    } else if (Param.consume_front("emit=")) {
+      if (Param.empty())
+        return false;
+      Options.EmitFile = Param.str();
+    } else if (Param.consume_front("context=")) {
+      if (Param.getAsInteger(10, Options.ContextDepth))
+        return false;
+    } else if (Param.consume_front("budget=")) {
+      if (Param.getAsInteger(10, Options.ContextBudget))
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+PreservedAnalyses PointsToBenchmark::run(Module& M, ModuleAnalysisManager& AM) {
+  using Clock = std::chrono::steady_clock;
+  double Total = 0;
+  size_t Pointers = 0;
+  // Incremental updates of the edits benchmark
+  double EditMs = 0;
+  size_t Edits = 0;
+  size_t Evaluated = 0;
+
+  if (Options.Mode == PointsToMode::Module) {
+    // One solve covers every function; the per-function views only index it
+    auto Start = Clock::now();
+    ModulePointerAnalysis Solution(M);
+    auto Solve = Clock::now();
+    if (Options.Reduce)
+      Solution.reduce();
+    double ReduceMs = std::chrono::duration<double, std::milli>(Clock::now() - Solve).count();
+    Solve = Clock::now();
+    Solution.solve(false, Options.Reduce);
+    double SolveMs = std::chrono::duration<double, std::milli>(Clock::now() - Solve).count();
+    Total = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+
+    for (auto& F : M) {
+      for (auto& Arg : F.args())
+        Pointers += Arg.getType()->isPointerTy();
+      for (auto& BB : F)
+        for (auto& I : BB)
+          Pointers += I.getType()->isPointerTy();
+    }
+    outs() << "Points-to on module: " << Solution.numNodes() << " nodes, "
+           << Solution.numSites() << " sites, " << Solution.numCallEdges()
+           << " call edges\n";
+    outs() << "Offline reduction: " << Solution.numMerged() << " nodes merged in "
+           << format("%.3f", ReduceMs) << " ms, solve " << format("%.3f", SolveMs) << " ms\n";
+    if (Options.Verify) {
+      // Outside the timing, so that the time is the reduced solve alone
+      ModulePointerAnalysis Unreduced(M);
+      Unreduced.solve(false, false);
+      if (!Solution.sameSolution(Unreduced))
+        report_fatal_error("points-to solution differs from the unreduced one");
+      outs() << "Points-to verified against the unreduced solver\n";
+    }
+    outs() << "Points-to total: " << Pointers << " pointers, " << format("%.3f", Total)
+           << " ms\n";
+    printPointsToStatistics();
+    return PreservedAnalyses::all();
+  }
+
+  for (auto& F : M) {
+    if (F.isDeclaration()) {
+      continue;
+    }
+
+    for (auto& Arg : F.args())
+      Pointers += Arg.getType()->isPointerTy();
+    for (auto& BB : F)
+      for (auto& I : BB)
+        Pointers += I.getType()->isPointerTy();
+
+    auto Start = Clock::now();
+    PointsToBackend* PA = createPointsToBackend(F, Options);
+    double Ms = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+    Total += Ms;
+
+    outs() << "Points-to on " << F.getName() << ": " << format("%.3f", Ms) << " ms";
+    if (Options.Mode == PointsToMode::BDD) {
+      auto* Symbolic = static_cast<BDDPointerAnalysis*>(PA);
+      outs() << ", " << Symbolic->memoryUsage() / 1024 << " KB of BDD nodes";
+    } else if (Options.Mode == PointsToMode::FlowSensitive) {
+      auto* Sparse = static_cast<FlowSensitivePointerAnalysis*>(PA);
+      outs() << ", " << Sparse->numMemoryNodes() << " memory nodes, "
+             << Sparse->numMemoryEdges() << " memory edges";
+    }
+    outs() << "\n";
+
+    if (Options.Mode == PointsToMode::Andersen && Options.Edits) {
+      // Each edit retracts one instruction and adds it back, so the solution
+      // after it is the one before
+      auto* Solver = static_cast<DoubleFreePointerAnalysis*>(PA);
+      std::vector<Instruction*> Insts;
+      for (auto& I : instructions(F))
+        Insts.push_back(&I);
+      size_t Step = std::max<size_t>(1, Insts.size() / Options.Edits);
+      for (size_t i = 0; i < Insts.size() && i / Step < Options.Edits; i += Step) {
+        // Verification is left out of the timing
+        auto Start = Clock::now();
+        Solver->removeInstructions(Insts[i]);
+        EditMs += std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+        Evaluated += Solver->numEvaluated();
+        if (Options.Verify && !Solver->verify())
+          report_fatal_error("incremental points-to removal differs from a solve from scratch");
+
+        Start = Clock::now();
+        Solver->addInstructions(Insts[i]);
+        EditMs += std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+        Evaluated += Solver->numEvaluated();
+        if (Options.Verify && !Solver->verify())
+          report_fatal_error("incremental points-to addition differs from a solve from scratch");
+        Edits++;
+      }
+    }
+    delete PA;
+  }
+
+  if (Edits) {
+    outs() << "Incremental total: " << Edits << " edits, "
+           << format("%.3f", EditMs / Edits) << " ms and "
+           << format("%.1f", double(Evaluated) / Edits) << " evaluations per edit\n";
+  }
+  outs() << "Points-to total: " << Pointers << " pointers, " << format("%.3f", Total)
+         << " ms\n";
+  printPointsToStatistics();
+  return PreservedAnalyses::all();
+}
+
+}  // namespace dataflow
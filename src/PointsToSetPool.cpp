@@ -0,0 +1,167 @@
+#include "PointsToSetPool.h"
+
+#include "SiteSetKernels.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace dataflow {
+
+PointsToSetPool::PointsToSetPool() {
+  intern({});
+}
+
+SiteID PointsToSetPool::site(const std::string& Name) {
+  auto It = SiteIDs.find(Name);
+  if (It != SiteIDs.end())
+    return It->second;
+
+  SiteID Site = SiteNames.size();
+  SiteIDs[Name] = Site;
+  SiteNames.push_back(Name);
+  return Site;
+}
+
+const std::string& PointsToSetPool::siteName(SiteID Site) const {
+  return SiteNames[Site];
+}
+
+size_t PointsToSetPool::numSites() const {
+  return SiteNames.size();
+}
+
+SetID PointsToSetPool::singleton(SiteID Site) {
+  return intern({Site});
+}
+
+SetID PointsToSetPool::fromSites(std::vector<SiteID> Sites) {
+  std::sort(Sites.begin(), Sites.end());
+  Sites.erase(std::unique(Sites.begin(), Sites.end()), Sites.end());
+  return intern(std::move(Sites));
+}
+
+SetID PointsToSetPool::setUnion(SetID A, SetID B) {
+  if (A == B || B == Empty)
+    return A;
+  if (A == Empty)
+    return B;
+
+  uint64_t Key = pairKey(A, B);
+  auto It = UnionCache.find(Key);
+  if (It != UnionCache.end())
+    return It->second;
+
+  std::vector<SiteID> Result;
+  sortedUnion(Sets[A], Sets[B], Result);
+
+  SetID ID = intern(std::move(Result));
+  UnionCache[Key] = ID;
+  return ID;
+}
+
+SetID PointsToSetPool::setIntersection(SetID A, SetID B) {
+  if (A == B)
+    return A;
+  if (!intersects(A, B))
+    return Empty;
+
+  uint64_t Key = pairKey(A, B);
+  auto It = IntersectionCache.find(Key);
+  if (It != IntersectionCache.end())
+    return It->second;
+
+  const std::vector<SiteID>& SA = Sets[A];
+  const std::vector<SiteID>& SB = Sets[B];
+  std::vector<SiteID> Result;
+  std::set_intersection(
+      SA.begin(), SA.end(), SB.begin(), SB.end(), std::back_inserter(Result));
+
+  SetID ID = intern(std::move(Result));
+  IntersectionCache[Key] = ID;
+  return ID;
+}
+
+bool PointsToSetPool::intersects(SetID A, SetID B) const {
+  if (A == B)
+    return A != Empty;
+  return sortedIntersects(Sets[A], Sets[B]);
+}
+
+SetID PointsToSetPool::setDifference(SetID A, SetID B) {
+  if (A == B || A == Empty)
+    return Empty;
+  if (B == Empty)
+    return A;
+
+  uint64_t Key = (uint64_t(A) << 32) | B;
+  auto It = DifferenceCache.find(Key);
+  if (It != DifferenceCache.end())
+    return It->second;
+
+  const std::vector<SiteID>& SA = Sets[A];
+  const std::vector<SiteID>& SB = Sets[B];
+  std::vector<SiteID> Result;
+  std::set_difference(SA.begin(), SA.end(), SB.begin(), SB.end(), std::back_inserter(Result));
+
+  SetID ID = intern(std::move(Result));
+  DifferenceCache[Key] = ID;
+  return ID;
+}
+
+const std::vector<SiteID>& PointsToSetPool::elements(SetID Set) const {
+  return Sets[Set];
+}
+
+size_t PointsToSetPool::size(SetID Set) const {
+  return Sets[Set].size();
+}
+
+size_t PointsToSetPool::numSets() const {
+  return Sets.size();
+}
+
+size_t PointsToSetPool::memoryUsage() const {
+  size_t Bytes = Sets.capacity() * sizeof(Sets[0]);
+  for (const std::vector<SiteID>& Set : Sets)
+    Bytes += Set.capacity() * sizeof(SiteID);
+  for (const std::string& Name : SiteNames)
+    Bytes += sizeof(Name) + Name.capacity();
+  // Hash table entries: key, value and about one pointer of overhead each
+  Bytes += Index.size() * (sizeof(uint64_t) + sizeof(SetID) + sizeof(void*));
+  Bytes += SiteIDs.size() * (sizeof(std::string) + sizeof(SiteID) + 4 * sizeof(void*));
+  Bytes += (UnionCache.size() + IntersectionCache.size() + DifferenceCache.size()) *
+           (sizeof(uint64_t) + sizeof(SetID) + sizeof(void*));
+  return Bytes;
+}
+
+SetID PointsToSetPool::intern(std::vector<SiteID>&& Elems) {
+  uint64_t H = hash(Elems);
+  auto Range = Index.equal_range(H);
+  for (auto It = Range.first; It != Range.second; ++It) {
+    if (Sets[It->second] == Elems)
+      return It->second;
+  }
+
+  SetID ID = Sets.size();
+  Sets.push_back(std::move(Elems));
+  Index.emplace(H, ID);
+  return ID;
+}
+
+uint64_t PointsToSetPool::hash(const std::vector<SiteID>& Elems) {
+  // FNV-1a over the site IDs
+  uint64_t H = 14695981039346656037ull;
+  for (SiteID Site : Elems) {
+    H ^= Site;
+    H *= 1099511628211ull;
+  }
+  return H;
+}
+
+uint64_t PointsToSetPool::pairKey(SetID A, SetID B) {
+  if (A > B)
+    std::swap(A, B);
+  return (uint64_t(A) << 32) | B;
+}
+
+}  // namespace dataflow
@@ -0,0 +1,324 @@
+#include "SiteSetKernels.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SITE_SET_KERNELS_X86 1
+#endif
+
+namespace dataflow {
+
+static_assert(sizeof(SiteID) == sizeof(uint32_t), "the kernels work on 32-bit lanes");
+
+namespace {
+
+enum class ISA { Scalar, SSE41, AVX2 };
+
+bool ForceScalar = false;
+
+ISA detectISA() {
+#ifdef SITE_SET_KERNELS_X86
+  if (__builtin_cpu_supports("avx2"))
+    return ISA::AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return ISA::SSE41;
+#endif
+  return ISA::Scalar;
+}
+
+ISA kernelISA() {
+  static const ISA Detected = detectISA();
+  return ForceScalar ? ISA::Scalar : Detected;
+}
+
+// A set this many times larger than the other is searched rather than merged
+constexpr size_t SearchRatio = 32;
+
+/**
+ * @brief Look the sites of the small set up in the large one, each search
+ * starting where the previous one ended.
+ */
+bool searchIntersects(const SiteID* Small, size_t SizeSmall, const SiteID* Large, size_t SizeLarge) {
+  const SiteID* End = Large + SizeLarge;
+  for (size_t i = 0; i < SizeSmall && Large != End; ++i) {
+    // Gallop to a range holding Small[i], then search it
+    size_t Step = 1;
+    while (Step < size_t(End - Large) && Large[Step] < Small[i])
+      Step *= 2;
+    const SiteID* Last = Large + std::min(Step + 1, size_t(End - Large));
+    Large = std::lower_bound(Large, Last, Small[i]);
+    if (Large != End && *Large == Small[i])
+      return true;
+  }
+  return false;
+}
+
+bool scalarIntersects(const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB) {
+  size_t i = 0, j = 0;
+  while (i < SizeA && j < SizeB) {
+    if (A[i] == B[j])
+      return true;
+    if (A[i] < B[j])
+      ++i;
+    else
+      ++j;
+  }
+  return false;
+}
+
+/**
+ * @brief Append the union of A and B to Out[0, N), skipping sites equal to
+ * the last one written; returns the new size.
+ */
+size_t scalarUnion(const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB, SiteID* Out, size_t N) {
+  auto Emit = [&](SiteID Site) {
+    if (N == 0 || Out[N - 1] != Site)
+      Out[N++] = Site;
+  };
+  size_t i = 0, j = 0;
+  while (i < SizeA && j < SizeB) {
+    if (A[i] < B[j]) {
+      Emit(A[i++]);
+    } else if (B[j] < A[i]) {
+      Emit(B[j++]);
+    } else {
+      Emit(A[i++]);
+      ++j;
+    }
+  }
+  while (i < SizeA)
+    Emit(A[i++]);
+  while (j < SizeB)
+    Emit(B[j++]);
+  return N;
+}
+
+/**
+ * @brief Union of a small set into a much larger one: the runs of the large
+ * set between sites of the small one are copied whole.
+ */
+size_t searchUnion(const SiteID* Small, size_t SizeSmall, const SiteID* Large, size_t SizeLarge, SiteID* Out) {
+  const SiteID* End = Large + SizeLarge;
+  size_t N = 0;
+  for (size_t i = 0; i < SizeSmall; ++i) {
+    const SiteID* Next = std::lower_bound(Large, End, Small[i]);
+    N = std::copy(Large, Next, Out + N) - Out;
+    if (Next == End || *Next != Small[i])
+      Out[N++] = Small[i];
+    Large = Next;
+  }
+  return std::copy(Large, End, Out + N) - Out;
+}
+
+#ifdef SITE_SET_KERNELS_X86
+
+// Block compares: after a block of A is compared with a block of B, the block
+// ending first cannot meet any later block of the other set, so it is
+// skipped. Both are skipped when they end on the same site.
+
+__attribute__((target("avx2"))) bool avx2Intersects(
+    const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB) {
+  const __m256i Rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+  size_t i = 0, j = 0;
+  while (i + 8 <= SizeA && j + 8 <= SizeB) {
+    __m256i VA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(A + i));
+    __m256i VB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(B + j));
+    __m256i Equal = _mm256_cmpeq_epi32(VA, VB);
+    for (int r = 1; r < 8; ++r) {
+      VB = _mm256_permutevar8x32_epi32(VB, Rotate);
+      Equal = _mm256_or_si256(Equal, _mm256_cmpeq_epi32(VA, VB));
+    }
+    if (!_mm256_testz_si256(Equal, Equal))
+      return true;
+    SiteID LastA = A[i + 7], LastB = B[j + 7];
+    i += LastA <= LastB ? 8 : 0;
+    j += LastB <= LastA ? 8 : 0;
+  }
+  return scalarIntersects(A + i, SizeA - i, B + j, SizeB - j);
+}
+
+__attribute__((target("sse4.1"))) bool sse41Intersects(
+    const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB) {
+  size_t i = 0, j = 0;
+  while (i + 4 <= SizeA && j + 4 <= SizeB) {
+    __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + i));
+    __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + j));
+    __m128i Equal = _mm_cmpeq_epi32(VA, VB);
+    VB = _mm_shuffle_epi32(VB, _MM_SHUFFLE(0, 3, 2, 1));
+    Equal = _mm_or_si128(Equal, _mm_cmpeq_epi32(VA, VB));
+    VB = _mm_shuffle_epi32(VB, _MM_SHUFFLE(0, 3, 2, 1));
+    Equal = _mm_or_si128(Equal, _mm_cmpeq_epi32(VA, VB));
+    VB = _mm_shuffle_epi32(VB, _MM_SHUFFLE(0, 3, 2, 1));
+    Equal = _mm_or_si128(Equal, _mm_cmpeq_epi32(VA, VB));
+    if (!_mm_testz_si128(Equal, Equal))
+      return true;
+    SiteID LastA = A[i + 3], LastB = B[j + 3];
+    i += LastA <= LastB ? 4 : 0;
+    j += LastB <= LastA ? 4 : 0;
+  }
+  return scalarIntersects(A + i, SizeA - i, B + j, SizeB - j);
+}
+
+/**
+ * @brief Merge two sorted vectors of 4 sites into the 4 smallest (Min) and
+ * the 4 largest (Max), both sorted: a bitonic network of rotations and
+ * min/max steps.
+ */
+__attribute__((target("sse4.1"))) inline void merge4(
+    __m128i A, __m128i B, __m128i& Min, __m128i& Max) {
+  __m128i Tmp = _mm_min_epu32(A, B);
+  Max = _mm_max_epu32(A, B);
+  for (int Step = 0; Step < 3; ++Step) {
+    Tmp = _mm_alignr_epi8(Tmp, Tmp, 4);
+    Min = _mm_min_epu32(Tmp, Max);
+    Max = _mm_max_epu32(Tmp, Max);
+    Tmp = Min;
+  }
+  Min = _mm_alignr_epi8(Min, Min, 4);
+}
+
+// For each mask of duplicate lanes, the shuffle packing the other lanes first
+struct UniqueShuffles {
+  alignas(16) uint8_t Bytes[16][16];
+
+  constexpr UniqueShuffles() : Bytes() {
+    for (int Mask = 0; Mask < 16; ++Mask) {
+      int Out = 0;
+      for (int Lane = 0; Lane < 4; ++Lane) {
+        if (Mask & (1 << Lane))
+          continue;
+        for (int Byte = 0; Byte < 4; ++Byte)
+          Bytes[Mask][Out * 4 + Byte] = Lane * 4 + Byte;
+        ++Out;
+      }
+      for (int Byte = Out * 4; Byte < 16; ++Byte)
+        Bytes[Mask][Byte] = 0x80;
+    }
+  }
+};
+constexpr UniqueShuffles Shuffles;
+
+/**
+ * @brief Store the sites of V that differ from their predecessor, the first
+ * one compared with the last lane of Prev; returns how many were stored.
+ * Always writes 16 bytes at Out.
+ */
+__attribute__((target("sse4.1"))) inline size_t storeUnique(__m128i Prev, __m128i V, SiteID* Out) {
+  __m128i Shifted = _mm_alignr_epi8(V, Prev, 12);
+  int Duplicates = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(V, Shifted)));
+  __m128i Shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(Shuffles.Bytes[Duplicates]));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(Out), _mm_shuffle_epi8(V, Shuffle));
+  return 4 - __builtin_popcount(Duplicates);
+}
+
+/**
+ * @brief Union of A and B into Out, which must have room for SizeA + SizeB + 4
+ * sites; returns the size of the union.
+ */
+__attribute__((target("sse4.1"))) size_t sse41Union(
+    const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB, SiteID* Out) {
+  if (SizeA < 4 || SizeB < 4)
+    return scalarUnion(A, SizeA, B, SizeB, Out, 0);
+
+  __m128i Min, Max;
+  merge4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(A)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(B)), Min, Max);
+  // Anything but the first site as the predecessor of the first site
+  __m128i Prev = _mm_shuffle_epi32(_mm_sub_epi32(Min, _mm_set1_epi32(1)), 0);
+  size_t N = storeUnique(Prev, Min, Out);
+  Prev = Min;
+
+  // The next block comes from the set with the smaller next site, so every
+  // site stored is at most every site not stored yet
+  size_t i = 4, j = 4;
+  while (i + 4 <= SizeA && j + 4 <= SizeB) {
+    __m128i Next;
+    if (A[i] <= B[j]) {
+      Next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + i));
+      i += 4;
+    } else {
+      Next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + j));
+      j += 4;
+    }
+    merge4(Next, Max, Min, Max);
+    N += storeUnique(Prev, Min, Out + N);
+    Prev = Min;
+  }
+
+  // Fewer than 4 sites are left in one of the sets: merge them with Max on
+  // the stack, then with the rest of the other set
+  alignas(16) SiteID Rest[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(Rest), Max);
+  const SiteID *Short = A + i, *Long = B + j;
+  size_t SizeShort = SizeA - i, SizeLong = SizeB - j;
+  if (SizeShort >= 4) {
+    std::swap(Short, Long);
+    std::swap(SizeShort, SizeLong);
+  }
+  SiteID Small[8];
+  size_t SizeSmall = scalarUnion(Rest, 4, Short, SizeShort, Small, 0);
+  return scalarUnion(Small, SizeSmall, Long, SizeLong, Out, N);
+}
+
+#endif  // SITE_SET_KERNELS_X86
+
+}  // namespace
+
+bool sortedIntersects(const SiteID* A, size_t SizeA, const SiteID* B, size_t SizeB) {
+  if (SizeA == 0 || SizeB == 0 || A[SizeA - 1] < B[0] || B[SizeB - 1] < A[0])
+    return false;
+  if (SizeA > SizeB) {
+    std::swap(A, B);
+    std::swap(SizeA, SizeB);
+  }
+  if (SizeA * SearchRatio < SizeB)
+    return searchIntersects(A, SizeA, B, SizeB);
+
+  switch (kernelISA()) {
+#ifdef SITE_SET_KERNELS_X86
+    case ISA::AVX2:
+      return avx2Intersects(A, SizeA, B, SizeB);
+    case ISA::SSE41:
+      return sse41Intersects(A, SizeA, B, SizeB);
+#endif
+    default:
+      return scalarIntersects(A, SizeA, B, SizeB);
+  }
+}
+
+void sortedUnion(const std::vector<SiteID>& A, const std::vector<SiteID>& B,
+    std::vector<SiteID>& Result) {
+  // Room for the last 16-byte store of the vector kernel
+  Result.resize(A.size() + B.size() + 4);
+  size_t N;
+  if (A.size() * SearchRatio < B.size())
+    N = searchUnion(A.data(), A.size(), B.data(), B.size(), Result.data());
+  else if (B.size() * SearchRatio < A.size())
+    N = searchUnion(B.data(), B.size(), A.data(), A.size(), Result.data());
+#ifdef SITE_SET_KERNELS_X86
+  else if (kernelISA() != ISA::Scalar)
+    N = sse41Union(A.data(), A.size(), B.data(), B.size(), Result.data());
+#endif
+  else
+    N = scalarUnion(A.data(), A.size(), B.data(), B.size(), Result.data(), 0);
+  Result.resize(N);
+}
+
+const char* siteSetKernelISA() {
+  switch (kernelISA()) {
+    case ISA::AVX2:
+      return "avx2";
+    case ISA::SSE41:
+      return "sse4.1";
+    default:
+      return "scalar";
+  }
+}
+
+void setScalarSiteSetKernels(bool Scalar) {
+  ForceScalar = Scalar;
+}
+
+}  // namespace dataflow
@@ -0,0 +1,127 @@
+#include "SmallSiteSet.h"
+
+#include <algorithm>
+
+namespace dataflow {
+
+void SmallSiteSet::spill(SiteID MaxSite) {
+  // Sized to the sites at hand rather than grown from another set, so that
+  // lengths do not compound as sets flow into each other
+  if (Size)
+    MaxSite = std::max(MaxSite, Inline[Size - 1]);
+  Bits.resize(MaxSite + 1);
+  for (unsigned i = 0; i < Size; ++i)
+    Bits.set(Inline[i]);
+}
+
+bool SmallSiteSet::insert(SiteID Site) {
+  if (isSpilled()) {
+    if (Site >= Bits.size())
+      Bits.resize(std::max<size_t>(Site + 1, 2 * Bits.size()));
+    else if (Bits.test(Site))
+      return false;
+    Bits.set(Site);
+    Size++;
+    return true;
+  }
+
+  SiteID* Pos = std::lower_bound(Inline, Inline + Size, Site);
+  if (Pos != Inline + Size && *Pos == Site)
+    return false;
+
+  if (Size < InlineCapacity) {
+    std::copy_backward(Pos, Inline + Size, Inline + Size + 1);
+    *Pos = Site;
+  } else {
+    spill(Site);
+    Bits.set(Site);
+  }
+  Size++;
+  return true;
+}
+
+bool SmallSiteSet::unionWith(const SmallSiteSet& Other) {
+  if (Other.empty() || this == &Other)
+    return false;
+
+  if (!isSpilled() && !Other.isSpilled()) {
+    // Merge the two sorted arrays; the result spills only past the capacity
+    SiteID Merged[2 * InlineCapacity];
+    SiteID* End = std::set_union(
+        Inline, Inline + Size, Other.Inline, Other.Inline + Other.Size, Merged);
+    unsigned NewSize = End - Merged;
+    if (NewSize == Size)
+      return false;
+
+    if (NewSize <= InlineCapacity) {
+      std::copy(Merged, End, Inline);
+    } else {
+      Bits.resize(End[-1] + 1);
+      for (SiteID* I = Merged; I != End; ++I)
+        Bits.set(*I);
+    }
+    Size = NewSize;
+    return true;
+  }
+
+  unsigned OldSize = Size;
+  if (!isSpilled()) {
+    spill(Other.Bits.size() - 1);
+    Size = InlineCapacity + 1;
+  }
+
+  if (Other.isSpilled()) {
+    Bits |= Other.Bits;
+  } else {
+    for (unsigned i = 0; i < Other.Size; ++i) {
+      SiteID Site = Other.Inline[i];
+      if (Site >= Bits.size())
+        Bits.resize(std::max<size_t>(Site + 1, 2 * Bits.size()));
+      Bits.set(Site);
+    }
+  }
+  Size = Bits.count();
+  return Size != OldSize;
+}
+
+bool SmallSiteSet::intersects(const SmallSiteSet& Other) const {
+  if (empty() || Other.empty())
+    return false;
+
+  if (isSpilled() && Other.isSpilled())
+    return Bits.anyCommon(Other.Bits);
+
+  if (!isSpilled() && !Other.isSpilled()) {
+    const SiteID *A = Inline, *AEnd = Inline + Size;
+    const SiteID *B = Other.Inline, *BEnd = Other.Inline + Other.Size;
+    while (A != AEnd && B != BEnd) {
+      if (*A == *B)
+        return true;
+      if (*A < *B)
+        ++A;
+      else
+        ++B;
+    }
+    return false;
+  }
+
+  const SmallSiteSet& Small = isSpilled() ? Other : *this;
+  const SmallSiteSet& Large = isSpilled() ? *this : Other;
+  for (unsigned i = 0; i < Small.Size; ++i) {
+    if (Large.contains(Small.Inline[i]))
+      return true;
+  }
+  return false;
+}
+
+bool SmallSiteSet::operator==(const SmallSiteSet& Other) const {
+  if (Size != Other.Size)
+    return false;
+  if (!isSpilled())
+    return std::equal(Inline, Inline + Size, Other.Inline);
+
+  // The bit vectors may have grown to different lengths
+  return std::equal(begin(), end(), Other.begin(), Other.end());
+}
+
+}  // namespace dataflow
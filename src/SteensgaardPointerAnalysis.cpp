@@ -0,0 +1,200 @@
+#include "SteensgaardPointerAnalysis.h"
+
+#include "Utils.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+
+namespace dataflow {
+
+unsigned SteensgaardPointerAnalysis::node(const std::string& Name) {
+  auto It = Nodes.find(Name);
+  if (It != Nodes.end())
+    return It->second;
+
+  unsigned N = Parent.size();
+  Nodes[Name] = N;
+  Parent.push_back(N);
+  Rank.push_back(0);
+  Pointee.push_back(NoPointee);
+  HasSite.push_back(false);
+  return N;
+}
+
+unsigned SteensgaardPointerAnalysis::site(const std::string& Name) {
+  unsigned N = node(Name);
+  HasSite[find(N)] = true;
+  return N;
+}
+
+unsigned SteensgaardPointerAnalysis::find(unsigned N) const {
+  unsigned Root = N;
+  while (Parent[Root] != Root)
+    Root = Parent[Root];
+  while (Parent[N] != Root) {
+    unsigned Next = Parent[N];
+    Parent[N] = Root;
+    N = Next;
+  }
+  return Root;
+}
+
+unsigned SteensgaardPointerAnalysis::pointee(unsigned N) {
+  N = find(N);
+  if (Pointee[N] == NoPointee) {
+    // Fresh anonymous class; the name cannot clash with LLVM values.
+    unsigned P = node("<pointee " + std::to_string(Parent.size()) + ">");
+    Pointee[N] = P;
+  }
+  return find(Pointee[N]);
+}
+
+void SteensgaardPointerAnalysis::join(unsigned A, unsigned B) {
+  // Unifying two classes also unifies their pointees; use an explicit
+  // worklist so long pointer chains cannot overflow the stack.
+  std::vector<std::pair<unsigned, unsigned>> WorkList = {{A, B}};
+  while (!WorkList.empty()) {
+    auto [X, Y] = WorkList.back();
+    WorkList.pop_back();
+    X = find(X);
+    Y = find(Y);
+    if (X == Y)
+      continue;
+
+    if (Rank[X] < Rank[Y])
+      std::swap(X, Y);
+    if (Rank[X] == Rank[Y])
+      Rank[X]++;
+    Parent[Y] = X;
+    HasSite[X] = HasSite[X] || HasSite[Y];
+
+    if (Pointee[X] == NoPointee) {
+      Pointee[X] = Pointee[Y];
+    } else if (Pointee[Y] != NoPointee) {
+      WorkList.push_back({Pointee[X], Pointee[Y]});
+    }
+  }
+}
+
+void SteensgaardPointerAnalysis::transfer(Instruction* Inst) {
+  if (AllocaInst* Alloca = dyn_cast<AllocaInst>(Inst)) {
+    join(pointee(node(variable(Alloca))), site(address(Alloca)));
+
+  } else if (StoreInst* Store = dyn_cast<StoreInst>(Inst)) {
+    if (!Store->getValueOperand()->getType()->isPointerTy())
+      return;
+
+    unsigned L = pointee(pointee(node(variable(Store->getPointerOperand()))));
+    unsigned R = pointee(node(variable(Store->getValueOperand())));
+    join(L, R);
+
+  } else if (LoadInst* Load = dyn_cast<LoadInst>(Inst)) {
+    if (!Load->getType()->isPointerTy())
+      return;
+
+    unsigned L = pointee(node(variable(Load)));
+    unsigned R = pointee(pointee(node(variable(Load->getPointerOperand()))));
+    join(L, R);
+
+  } else if (auto* Call = dyn_cast<CallInst>(Inst)) {
+    if (Call->getType()->isPointerTy()) {
+      join(pointee(node(variable(Call))), site(address(Call)));
+    }
+
+  } else if (auto* Cast = dyn_cast<CastInst>(Inst)) {
+    if (Cast->getType()->isPointerTy() && Cast->getOperand(0)->getType()->isPointerTy()) {
+      join(pointee(node(variable(Cast))), pointee(node(variable(Cast->getOperand(0)))));
+    }
+
+  } else if (auto* GEP = dyn_cast<GetElementPtrInst>(Inst)) {
+    if (GEP->getType()->isPointerTy()) {
+      join(pointee(node(variable(GEP))), pointee(node(variable(GEP->getPointerOperand()))));
+    }
+
+  } else if (auto* Phi = dyn_cast<PHINode>(Inst)) {
+    if (!Phi->getType()->isPointerTy()) {
+      return;
+    }
+
+    unsigned P = pointee(node(variable(Phi)));
+    for (unsigned i = 0; i < Phi->getNumIncomingValues(); ++i) {
+      Value* Incoming = Phi->getIncomingValue(i);
+      if (!Incoming->getType()->isPointerTy()) {
+        continue;
+      }
+      join(P, pointee(node(variable(Incoming))));
+    }
+  }
+}
+
+SteensgaardPointerAnalysis::SteensgaardPointerAnalysis(Function& F) {
+  for (auto& Arg : F.args()) {
+    if (Arg.getType()->isPointerTy()) {
+      join(pointee(node(variable(&Arg))), site(address(&Arg)));
+    }
+  }
+
+  // Unification is order-independent, so one pass reaches the fixpoint.
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    transfer(&*Iter);
+  }
+
+  for (const std::string& Name : pointerVariables(F)) {
+    auto It = Nodes.find(Name);
+    if (It == Nodes.end())
+      continue;
+    unsigned P = Pointee[find(It->second)];
+    if (P != NoPointee) {
+      PointedBy[find(P)].push_back(&It->first);
+    }
+  }
+}
+
+bool SteensgaardPointerAnalysis::alias(std::string& Ptr1, std::string& Ptr2) const {
+  auto It1 = Nodes.find(Ptr1);
+  auto It2 = Nodes.find(Ptr2);
+  if (It1 == Nodes.end() || It2 == Nodes.end())
+    return false;
+
+  unsigned P1 = Pointee[find(It1->second)];
+  unsigned P2 = Pointee[find(It2->second)];
+  if (P1 == NoPointee || P2 == NoPointee)
+    return false;
+
+  P1 = find(P1);
+  return P1 == find(P2) && HasSite[P1];
+}
+
+std::vector<std::string> SteensgaardPointerAnalysis::aliases(const std::string& Ptr) const {
+  auto It = Nodes.find(Ptr);
+  if (It == Nodes.end())
+    return {};
+
+  unsigned P = Pointee[find(It->second)];
+  if (P == NoPointee || !HasSite[find(P)])
+    return {};
+
+  // Everything pointing into the same class aliases Ptr
+  std::vector<std::string> Result;
+  for (const std::string* Name : PointedBy.at(find(P))) {
+    if (Name != &It->first)
+      Result.push_back(*Name);
+  }
+  return Result;
+}
+
+bool SteensgaardPointerAnalysis::freesMayAlias(Function& F) const {
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    auto* Call = dyn_cast<CallInst>(&*Iter);
+    if (!Call || !Call->getCalledFunction() || Call->arg_size() < 1 ||
+        !Call->getCalledFunction()->getName().equals("free")) {
+      continue;
+    }
+
+    if (!aliases(variable(Call->getArgOperand(0))).empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+};  // namespace dataflow
@@ -0,0 +1,227 @@
+#include "SummaryIndex.h"
+
+#include "AnalysisCache.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace dataflow {
+
+//===----------------------------------------------------------------------===//
+// Cross-Module Summary Index Implementation
+//===----------------------------------------------------------------------===//
+
+// "CWEI", and the version of the layout described in SummaryIndex.h
+static constexpr uint32_t IndexMagic = 0x49455743;
+static constexpr uint32_t IndexFormat = 1;
+
+void SummaryIndex::add(StringRef Name, FunctionSummary Summary, std::vector<SummaryEdge> Edges) {
+  Entry& E = Functions[Name.str()];
+  E.Summary = std::move(Summary);
+  E.Edges = std::move(Edges);
+}
+
+const FunctionSummary* SummaryIndex::lookup(StringRef Name) const {
+  auto It = Functions.find(Name);
+  return It == Functions.end() ? nullptr : &It->second.Summary;
+}
+
+unsigned SummaryIndex::merge(const SummaryIndex& Other) {
+  unsigned Duplicates = 0;
+  for (auto& I : Other.Functions) {
+    if (!Functions.insert(I).second)
+      Duplicates++;
+  }
+  return Duplicates;
+}
+
+unsigned SummaryIndex::propagate() {
+  unsigned Rounds = 0;
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    Rounds++;
+    for (auto& I : Functions) {
+      FunctionSummary& S = I.second.Summary;
+      const unsigned Fresh = S.Frees.size();
+      for (const SummaryEdge& Edge : I.second.Edges) {
+        auto It = Functions.find(Edge.Callee);
+        if (It == Functions.end())
+          continue;
+        // May be S itself, for a recursive call
+        const FunctionSummary& Callee = It->second.Summary;
+        if (Edge.Arg >= Callee.Frees.size())
+          continue;
+
+        if (Edge.Param == Fresh) {
+          if (Callee.Frees.test(Edge.Arg) && S.ReturnsFresh) {
+            S.ReturnsFresh = false;
+            Changed = true;
+          }
+          continue;
+        }
+        if (Edge.Param > Fresh)
+          continue;
+        for (auto Fact : {&FunctionSummary::Frees, &FunctionSummary::Derefs,
+                 &FunctionSummary::Escapes}) {
+          if ((Callee.*Fact).test(Edge.Arg) && !(S.*Fact).test(Edge.Param)) {
+            (S.*Fact).set(Edge.Param);
+            Changed = true;
+          }
+        }
+      }
+    }
+  }
+  return Rounds;
+}
+
+bool SummaryIndex::write(StringRef Path, std::string& Error) const {
+  // Every name once, the functions first
+  StringMap<uint32_t> NameIDs;
+  std::vector<StringRef> Names;
+  auto NameID = [&](StringRef Name) {
+    auto Inserted = NameIDs.insert({Name, Names.size()});
+    if (Inserted.second)
+      Names.push_back(Inserted.first->first());
+    return Inserted.first->second;
+  };
+  for (auto& I : Functions)
+    NameID(I.first);
+  for (auto& I : Functions) {
+    for (const SummaryEdge& Edge : I.second.Edges)
+      NameID(Edge.Callee);
+  }
+
+  std::vector<uint32_t> Words = {IndexMagic, IndexFormat, AnalysisCache::AnalysisVersion};
+  Words.push_back(Names.size());
+  for (StringRef Name : Names) {
+    Words.push_back(Name.size());
+    size_t First = Words.size();
+    Words.resize(First + (Name.size() + 3) / 4);
+    for (size_t i = 0; i < Name.size(); ++i)
+      Words[First + i / 4] |= uint32_t(uint8_t(Name[i])) << (8 * (i % 4));
+  }
+  Words.push_back(Functions.size());
+  for (auto& I : Functions) {
+    Words.push_back(NameIDs.lookup(I.first));
+    I.second.Summary.serialize(Words);
+    Words.push_back(I.second.Edges.size());
+    for (const SummaryEdge& Edge : I.second.Edges) {
+      Words.push_back(Edge.Param);
+      Words.push_back(NameIDs.lookup(Edge.Callee));
+      Words.push_back(Edge.Arg);
+    }
+  }
+
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC);
+  if (EC) {
+    Error = EC.message();
+    return false;
+  }
+  support::endian::Writer Writer(OS, support::little);
+  for (uint32_t W : Words)
+    Writer.write<uint32_t>(W);
+  OS.close();
+  if (OS.has_error()) {
+    Error = OS.error().message();
+    OS.clear_error();
+    return false;
+  }
+  return true;
+}
+
+bool SummaryIndex::read(StringRef Path, std::string& Error) {
+  auto Buffer = MemoryBuffer::getFile(Path, /*IsText=*/false,
+      /*RequiresNullTerminator=*/false);
+  if (!Buffer) {
+    Error = Buffer.getError().message();
+    return false;
+  }
+
+  StringRef Data = (*Buffer)->getBuffer();
+  if (Data.size() % 4) {
+    Error = "truncated summary index";
+    return false;
+  }
+  std::vector<uint32_t> Storage(Data.size() / 4);
+  for (size_t i = 0; i < Storage.size(); ++i)
+    Storage[i] = support::endian::read32le(Data.data() + 4 * i);
+  ArrayRef<uint32_t> Words = Storage;
+
+  auto Malformed = [&] {
+    Error = "malformed summary index";
+    return false;
+  };
+  auto Next = [&](uint32_t& W) {
+    if (Words.empty())
+      return false;
+    W = Words.front();
+    Words = Words.drop_front();
+    return true;
+  };
+
+  uint32_t Magic, Format, Version, NumNames;
+  if (!Next(Magic) || !Next(Format) || !Next(Version) || Magic != IndexMagic)
+    return Malformed();
+  if (Format != IndexFormat || Version != AnalysisCache::AnalysisVersion) {
+    Error = "summary index of another version";
+    return false;
+  }
+
+  if (!Next(NumNames))
+    return Malformed();
+  std::vector<std::string> Names;
+  for (uint32_t i = 0; i < NumNames; ++i) {
+    uint32_t Length;
+    if (!Next(Length) || Words.size() < (size_t(Length) + 3) / 4)
+      return Malformed();
+    std::string Name(Length, '\0');
+    for (size_t c = 0; c < Length; ++c)
+      Name[c] = char(Words[c / 4] >> (8 * (c % 4)));
+    Words = Words.drop_front((size_t(Length) + 3) / 4);
+    Names.push_back(std::move(Name));
+  }
+
+  SummaryIndex Read;
+  uint32_t NumFunctions;
+  if (!Next(NumFunctions))
+    return Malformed();
+  for (uint32_t i = 0; i < NumFunctions; ++i) {
+    uint32_t Name, NumEdges;
+    FunctionSummary Summary;
+    if (!Next(Name) || Name >= Names.size() || !Summary.deserialize(Words) || !Next(NumEdges))
+      return Malformed();
+    std::vector<SummaryEdge> Edges;
+    for (uint32_t e = 0; e < NumEdges; ++e) {
+      uint32_t Param, Callee, Arg;
+      if (!Next(Param) || !Next(Callee) || !Next(Arg) || Callee >= Names.size())
+        return Malformed();
+      Edges.push_back({Param, Names[Callee], Arg});
+    }
+    Read.add(Names[Name], std::move(Summary), std::move(Edges));
+  }
+  if (!Words.empty())
+    return Malformed();
+
+  merge(Read);
+  return true;
+}
+
+std::string indexName(const Function& F) {
+  if (!F.hasLocalLinkage())
+    return F.getName().str();
+  return (F.getParent()->getModuleIdentifier() + ":" + F.getName()).str();
+}
+
+void importSummaryIndex(FunctionSummaries& Summaries, StringRef Path) {
+  SummaryIndex Index;
+  std::string Error;
+  if (!Index.read(Path, Error))
+    report_fatal_error(Twine("cannot read summary index ") + Path + ": " + Error);
+  Summaries.import(Index);
+}
+
+}  // namespace dataflow
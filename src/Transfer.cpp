@@ -17,6 +17,33 @@ static void updateDomain(Memory& NOut, const std::string& Name, Domain* NewDom)
   }
 }
 
+/**
+ * @brief Apply the summary S of the callee of Call: the arguments it may free
+ * and their aliases join Freed, and a fresh result is Live, as after malloc.
+ */
+static void applySummary(CallInst* Call,
+    const FunctionSummary& S,
+    const Memory* In,
+    Memory& NOut,
+    PointsToBackend* PA) {
+  Domain Freed(Domain::Freed);
+  unsigned NumArgs = std::min<unsigned>(Call->arg_size(), S.Frees.size());
+  for (unsigned k = 0; k < NumArgs; ++k) {
+    if (!S.Frees.test(k)) {
+      continue;
+    }
+    Value* Arg = Call->getArgOperand(k);
+    NOut[variable(Arg)] = Domain::join(getOrExtract(In, Arg), &Freed);
+    for (const std::string& vName : PA->aliasesOf(Arg)) {
+      NOut[vName] = Domain::join(getOrExtract(In, vName), &Freed);
+    }
+  }
+
+  if (S.ReturnsFresh) {
+    NOut[variable(Call)] = new Domain(Domain::Live, Domain::NotNull);
+  }
+}
+
 /**
  * @brief Evaluate a Value to get its Domain.
  */
@@ -47,8 +74,7 @@ Domain* evalCopyLike(Value* V, const Memory* InMem) {
 void DoubleFreeAnalysis::transfer(Instruction* Inst,
     const Memory* In,
     Memory& NOut,
-    DoubleFreePointerAnalysis* PA,
-    SetVector<Value*> PointerSet) {
+    PointsToBackend* PA) {
   // Copy In into NOut as a default
   for (const auto& kv : *In) {
     NOut[kv.first] = new Domain(*kv.second);
@@ -71,27 +97,26 @@ void DoubleFreeAnalysis::transfer(Instruction* Inst,
       if (Name.equals("free")) {
         if (Call->arg_size() >= 1) {
           Value* Arg = Call->getArgOperand(0);
-          std::string argName = variable(Arg);
+          // Named once; the aliases come from the memoized query
+          std::string ArgName = variable(Arg);
           // Preserve existing nullness when marking Freed
-          Domain* Prev = getOrExtract(In, Arg);
-          NOut[variable(Arg)] = new Domain(Domain::Freed, Prev->Nstate);
-
-          for (Value* V : PointerSet) {
-            if (!V->getType()->isPointerTy()) {
-              continue;
-            }
-
-            std::string vName = variable(V);
-            if (vName == argName) {
-              continue;
-            }
-
-            if (PA->alias(argName, vName)) {
-              Domain* PrevV = getOrExtract(In, V);
-              NOut[vName] = new Domain(Domain::Freed, PrevV->Nstate);
-            }
+          Domain* Prev = getOrExtract(In, ArgName);
+          NOut[ArgName] = new Domain(Domain::Freed, Prev->Nstate);
+
+          // Every pointer that may alias the argument is freed too
+          for (const std::string& vName : PA->aliasesOf(Arg)) {
+            Domain* PrevV = getOrExtract(In, vName);
+            NOut[vName] = new Domain(Domain::Freed, PrevV->Nstate);
           }
         }
+        return;
+      }
+
+      // Defined function: apply its summary instead of analyzing it
+      if (Summaries) {
+        if (const FunctionSummary* S = Summaries->lookup(Call->getCalledFunction())) {
+          applySummary(Call, *S, In, NOut, PA);
+        }
       }
       return;
     }
@@ -164,8 +189,7 @@ void DoubleFreeAnalysis::transfer(Instruction* Inst,
 void UseAfterFreeAnalysis::transfer(Instruction* Inst,
     const Memory* In,
     Memory& NOut,
-    DoubleFreePointerAnalysis* PA,
-    SetVector<Value*> PointerSet) {
+    PointsToBackend* PA) {
   // Copy In into NOut as a default
   for (const auto& kv : *In) {
     NOut[kv.first] = new Domain(*kv.second);
@@ -188,27 +212,26 @@ void UseAfterFreeAnalysis::transfer(Instruction* Inst,
       if (Name.equals("free")) {
         if (Call->arg_size() >= 1) {
           Value* Arg = Call->getArgOperand(0);
-          std::string argName = variable(Arg);
+          // Named once; the aliases come from the memoized query
+          std::string ArgName = variable(Arg);
           // Preserve existing nullness when marking Freed
-          Domain* Prev = getOrExtract(In, Arg);
-          NOut[variable(Arg)] = new Domain(Domain::Freed, Prev->Nstate);
-
-          for (Value* V : PointerSet) {
-            if (!V->getType()->isPointerTy()) {
-              continue;
-            }
-
-            std::string vName = variable(V);
-            if (vName == argName) {
-              continue;
-            }
-
-            if (PA->alias(argName, vName)) {
-              Domain* PrevV = getOrExtract(In, V);
-              NOut[vName] = new Domain(Domain::Freed, PrevV->Nstate);
-            }
+          Domain* Prev = getOrExtract(In, ArgName);
+          NOut[ArgName] = new Domain(Domain::Freed, Prev->Nstate);
+
+          // Every pointer that may alias the argument is freed too
+          for (const std::string& vName : PA->aliasesOf(Arg)) {
+            Domain* PrevV = getOrExtract(In, vName);
+            NOut[vName] = new Domain(Domain::Freed, PrevV->Nstate);
           }
         }
+        return;
+      }
+
+      // Defined function: apply its summary instead of analyzing it
+      if (Summaries) {
+        if (const FunctionSummary* S = Summaries->lookup(Call->getCalledFunction())) {
+          applySummary(Call, *S, In, NOut, PA);
+        }
       }
       return;
     }
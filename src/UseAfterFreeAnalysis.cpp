@@ -1,8 +1,14 @@
 #include "UseAfterFreeAnalysis.h"
 
+#include "AnalysisCache.h"
+#include "ModulePointerAnalysis.h"
+#include "SummaryIndex.h"
 #include "Utils.h"
 #include <llvm/Passes/PassPlugin.h>
 
+#include <chrono>
+#include <memory>
+
 namespace dataflow {
 
 //===----------------------------------------------------------------------===//
@@ -35,6 +41,10 @@ bool UseAfterFreeAnalysis::check(Instruction* Inst) {
 
   // Check for call instruction with freed pointer argument
   if (auto* Call = dyn_cast<CallInst>(Inst)) {
+    // A summarized callee only uses the arguments it dereferences or frees
+    Function* Callee = Call->getCalledFunction();
+    const FunctionSummary* S = Summaries && Callee ? Summaries->lookup(Callee) : nullptr;
+
     for (unsigned i = 0; i < Call->arg_size(); ++i) {
       Value* Arg = Call->getArgOperand(i);
 
@@ -42,6 +52,10 @@ bool UseAfterFreeAnalysis::check(Instruction* Inst) {
         continue;
       }
 
+      if (S && i < S->Derefs.size() && !S->Derefs.test(i) && !S->Frees.test(i)) {
+        continue;
+      }
+
       Domain* D = getOrExtract(In, Arg);
 
       if (D->Value != Domain::Live) {
@@ -59,6 +73,56 @@ const auto PASS_DESC = "Use-after-free Analysis";
 PreservedAnalyses UseAfterFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM) {
   outs() << "Running " << PASS_DESC << " on module " << M.getName() << "\n";
 
+  // Summaries and warnings of earlier runs, for the functions left unchanged
+  std::unique_ptr<AnalysisCache> SummaryCache, ResultCache;
+  if (!Options.CacheDir.empty()) {
+    SummaryCache = std::make_unique<AnalysisCache>(Options.CacheDir);
+    // The `module` solution of a function depends on the whole module, and
+    // its warnings in context on its callers
+    if (Options.Mode != PointsToMode::Module && Options.ContextDepth == 0)
+      ResultCache = std::make_unique<AnalysisCache>(Options.CacheDir);
+  }
+
+  // Summarized bottom-up once per module, before any function is analyzed
+  FunctionSummaries& ModuleSummaries = AM.getResult<FunctionSummaryAnalysis>(M);
+  // Functions defined in other modules, as summarized when the index was linked
+  if (!Options.IndexFile.empty()) {
+    importSummaryIndex(ModuleSummaries, Options.IndexFile);
+  }
+  ModuleSummaries.compute(Options.Threads, Options.Verify, SummaryCache.get());
+  Summaries = &ModuleSummaries;
+
+  // Each function in the states its callers pass, before any warning is
+  // printed. The facts of each context are printed as it is analyzed.
+  std::unique_ptr<CallContexts> Contexts;
+  if (Options.ContextDepth > 0) {
+    Contexts = std::make_unique<CallContexts>(
+        M, Options.ContextDepth, Options.ContextBudget, Domain::Live);
+    Contexts->run([&](Function& F,
+                      const ContextInput& Input,
+                      SetVector<Instruction*>& Errors,
+                      std::vector<ContextCall>& Calls) {
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        InMap[&(*Iter)] = new Memory;
+        OutMap[&(*Iter)] = new Memory;
+      }
+
+      doAnalysis(F, &getPointsToBackend(F, Options, AM), &Input);
+
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        if (check(&(*Iter)))
+          Errors.insert(&(*Iter));
+      }
+      addContextCalls(F, InMap, Calls);
+      printContextMap(F, Input, InMap, OutMap);
+
+      for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
+        delete InMap[&(*Iter)];
+        delete OutMap[&(*Iter)];
+      }
+    });
+  }
+
   for (auto& F : M) {
     if (F.isDeclaration()) {
       continue;
@@ -68,6 +132,29 @@ PreservedAnalyses UseAfterFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM
 
     ErrorInsts.clear();
 
+    if (Contexts) {
+      ErrorInsts = Contexts->errors(F);
+      printErrorInsts();
+      continue;
+    }
+
+    MD5::MD5Result Key;
+    SetVector<Instruction*> CachedInsts;
+    bool Cached = false;
+    if (ResultCache) {
+      Key = resultKey(F, getAnalysisName(), Options, *Summaries);
+      std::vector<uint32_t> Positions;
+      Cached = ResultCache->lookup(Key, Positions) && instructionsAt(F, Positions, CachedInsts);
+    }
+    // With verify, a cached function is analyzed again and compared. Otherwise
+    // it prints its warnings only, as it has no dataflow facts to dump
+    if (Cached && !Options.Verify) {
+      ErrorInsts = CachedInsts;
+      printErrorInsts();
+      continue;
+    }
+    auto Start = std::chrono::steady_clock::now();
+
     // Initializing InMap and OutMap.
     for (inst_iterator Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
       auto Inst = &(*Iter);
@@ -76,7 +163,8 @@ PreservedAnalyses UseAfterFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM
     }
 
     // The chaotic iteration algorithm is implemented inside doAnalysis().
-    auto PA = new DoubleFreePointerAnalysis(F);
+    // Shared with any other pass of the pipeline that asked for it
+    PointsToBackend* PA = &getPointsToBackend(F, Options, AM);
     doAnalysis(F, PA);
 
     // Check each instruction in function F for potential divide-by-zero error.
@@ -86,11 +174,21 @@ PreservedAnalyses UseAfterFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM
         ErrorInsts.insert(Inst);
     }
 
+    if (Cached && CachedInsts != ErrorInsts) {
+      report_fatal_error(Twine("cached warnings of ") + F.getName() + " differ from a fresh analysis");
+    }
+    if (ResultCache && !Cached) {
+      ResultCache->store(Key, instructionPositions(F, ErrorInsts),
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start)
+              .count());
+    }
+
     printMap(F, InMap, OutMap);
-    outs() << "Potential Instructions by " << getAnalysisName() << ": \n";
-    for (auto Inst : ErrorInsts) {
-      outs() << *Inst << "\n";
+    if (Options.Stats) {
+      errs() << "Alias cache: " << PA->cacheHits() << " hits, " << PA->cacheMisses()
+             << " misses\n\n";
     }
+    printErrorInsts();
 
     for (auto Iter = inst_begin(F), End = inst_end(F); Iter != End; ++Iter) {
       delete InMap[&(*Iter)];
@@ -98,18 +196,45 @@ PreservedAnalyses UseAfterFreeAnalysis::run(Module& M, ModuleAnalysisManager& AM
     }
   }
 
+  // The warnings are buffered, the summaries are not
+  outs().flush();
+  if (SummaryCache) {
+    SummaryCache->print(errs(), "Summary");
+  }
+  if (ResultCache) {
+    ResultCache->print(errs(), getAnalysisName());
+  }
+  if (Contexts) {
+    Contexts->print(errs(), getAnalysisName());
+  }
+  printPointsToStatistics();
   return PreservedAnalyses::all();
 }
 
+void UseAfterFreeAnalysis::printErrorInsts() {
+  outs() << "Potential Instructions by " << getAnalysisName() << ": \n";
+  for (auto Inst : ErrorInsts) {
+    outs() << *Inst << "\n";
+  }
+}
+
 // Pass registration for the new pass manager
 extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
   return {LLVM_PLUGIN_API_VERSION, PASS_NAME, "1.0.0", [](PassBuilder& PB) {
+            PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager& FAM) {
+              FAM.registerPass([] { return PointsToAnalysis(); });
+            });
+            PB.registerAnalysisRegistrationCallback([](ModuleAnalysisManager& MAM) {
+              MAM.registerPass([] { return ModulePointsToAnalysis(); });
+              MAM.registerPass([] { return FunctionSummaryAnalysis(); });
+            });
             PB.registerPipelineParsingCallback(
                 [](StringRef Name,
                     ModulePassManager& MPM,
                     ArrayRef<PassBuilder::PipelineElement>) {
-                  if (Name == PASS_NAME) {
-                    MPM.addPass(UseAfterFreeAnalysis());
+                  PointsToOptions Options;
+                  if (parsePointsToOptions(Name, PASS_NAME, Options)) {
+                    MPM.addPass(UseAfterFreeAnalysis(Options));
                     return true;
                   }
                   return false;
@@ -2,6 +2,7 @@
 
 #include "Domain.h"
 #include "DoubleFreeAnalysis.h"
+#include "llvm/IR/Operator.h"
 
 const char* WHITESPACES = " \t\n\r";
 const size_t VARIABLE_PADDED_LEN = 8;
@@ -26,7 +27,10 @@ std::string variable(const Value* Val) {
   if (RetVal == "ret" || RetVal == "br" || RetVal == "store") {
     return Code;
   }
-  if (RetVal == "i1" || RetVal == "i8" || RetVal == "i32" || RetVal == "i64") {
+  // Arguments print as their type and name, and the type alone would let
+  // all the arguments of a type share one state, with or without contexts
+  if (RetVal == "i1" || RetVal == "i8" || RetVal == "i32" || RetVal == "i64" ||
+      isa<Argument>(Val)) {
     RetVal = Code;
   }
   for (auto i = RetVal.size(); i < VARIABLE_PADDED_LEN; i++) {
@@ -44,14 +48,30 @@ std::string address(const Value* Val) {
   return Code;
 }
 
-Domain* getOrExtract(const Memory* Mem, const Value* Val) {
-  auto it = Mem->find(variable(Val));
+const Value* stripConstant(const Value* V) {
+  while (auto* Op = dyn_cast<Operator>(V)) {
+    if (!isa<ConstantExpr>(Op) ||
+        (!isa<BitCastOperator>(Op) && !isa<GEPOperator>(Op) &&
+            !isa<AddrSpaceCastOperator>(Op))) {
+      break;
+    }
+    V = Op->getOperand(0);
+  }
+  return V;
+}
+
+Domain* getOrExtract(const Memory* Mem, const std::string& Name) {
+  auto it = Mem->find(Name);
   if (it != Mem->end()) {
     return it->second;
   }
   return new Domain(Domain::Uninit, Domain::Unknown);
 }
 
+Domain* getOrExtract(const Memory* Mem, const Value* Val) {
+  return getOrExtract(Mem, variable(Val));
+}
+
 void printMemory(const Memory* Mem) {
   for (auto Iter = Mem->begin(), End = Mem->end(); Iter != End; ++Iter) {
     errs() << "    [ " << Iter->first << " |-> " << *Iter->second << " ]\n";
@@ -86,4 +106,34 @@ void printMap(Function& F,
   }
 }
 
+void addContextCalls(Function& F,
+    std::map<Instruction*, Memory*>& InMap,
+    std::vector<ContextCall>& Calls) {
+  for (inst_iterator Iter = inst_begin(F), E = inst_end(F); Iter != E; ++Iter) {
+    auto* Call = dyn_cast<CallInst>(&(*Iter));
+    Function* Callee = Call ? Call->getCalledFunction() : nullptr;
+    if (!Callee || Callee->isDeclaration()) {
+      continue;
+    }
+    ContextInput Input;
+    for (Value* Arg : Call->args()) {
+      Input.push_back(
+          Arg->getType()->isPointerTy() ? getOrExtract(InMap[Call], Arg)->Value : Domain::Uninit);
+    }
+    Calls.emplace_back(Callee, std::move(Input));
+  }
+}
+
+void printContextMap(Function& F,
+    const ContextInput& Input,
+    std::map<Instruction*, Memory*>& InMap,
+    std::map<Instruction*, Memory*>& OutMap) {
+  errs() << "Context of " << F.getName() << ": (";
+  for (size_t I = 0; I < Input.size(); ++I) {
+    errs() << (I ? ", " : "") << Domain(Input[I]);
+  }
+  errs() << ")\n";
+  printMap(F, InMap, OutMap);
+}
+
 }  // namespace dataflow
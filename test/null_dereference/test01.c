@@ -0,0 +1,17 @@
+#include <stdlib.h>
+
+struct pair {
+  int* first;
+  int* second;
+};
+
+int main() {
+  struct pair s;
+  s.first = NULL;
+  s.second = (int*)malloc(sizeof(int));
+  if (!s.second) {
+    return 0;
+  }
+
+  return *s.first;  // NULL dereference, s.second is another field
+}
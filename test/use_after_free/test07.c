@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+void print(char* s) {
+  puts(s);
+}
+
+int main() {
+  char* s = malloc(8);
+  s[0] = '\0';
+  free(s);
+  print(s);  // UAF (the callee passes it on to a library function)
+  return 0;
+}
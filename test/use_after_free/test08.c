@@ -0,0 +1,18 @@
+#include <stdlib.h>
+
+void g(int* p, int* q) {
+  free(p);
+  *q = 1;  // q is another object, no use-after-free
+}
+
+int main() {
+  int* p = (int*)malloc(sizeof(int));
+  int* q = (int*)malloc(sizeof(int));
+  if (!p || !q) {
+    return 0;
+  }
+
+  g(p, q);
+  free(q);
+  return 0;
+}
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+// Summary index linker
+//===----------------------------------------------------------------------===//
+//
+// Merges the summary files written by `FunctionSummary<emit=FILE>` for
+// several modules into one index, and propagates the facts of each function
+// to its callers across the modules, see SummaryIndex.h. Each module is then
+// checked on its own with `DoubleFree<index=OUT>` or `UseAfterFree<index=OUT>`.
+//
+// Usage: SummaryLink OUT IN...
+//
+//===----------------------------------------------------------------------===//
+
+#include "SummaryIndex.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <chrono>
+
+using namespace llvm;
+using namespace dataflow;
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    errs() << "usage: " << argv[0] << " OUT IN...\n";
+    return 2;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto Start = Clock::now();
+
+  SummaryIndex Index;
+  unsigned Duplicates = 0;
+  for (int i = 2; i < argc; ++i) {
+    SummaryIndex Module;
+    std::string Error;
+    if (!Module.read(argv[i], Error)) {
+      errs() << argv[0] << ": " << argv[i] << ": " << Error << "\n";
+      return 1;
+    }
+    Duplicates += Index.merge(Module);
+  }
+  unsigned Rounds = Index.propagate();
+
+  std::string Error;
+  if (!Index.write(argv[1], Error)) {
+    errs() << argv[0] << ": " << argv[1] << ": " << Error << "\n";
+    return 1;
+  }
+
+  double Ms = std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+  outs() << "Linked " << Index.size() << " functions of " << argc - 2 << " modules in " << Rounds
+         << " rounds, " << format("%.3f", Ms) << " ms\n";
+  if (Duplicates)
+    outs() << Duplicates << " functions defined more than once, the first definition kept\n";
+  return 0;
+}